@@ -1,7 +1,50 @@
 #include <iostream>
 #include <mutex>
 #include <random>
+#include <thread>
 #include <condition_variable>
+#include <cstdarg>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <bitset>
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <algorithm>
+#include <new>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <linux/mempolicy.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 class UniformRandInt
 {
@@ -12,6 +55,14 @@ public:
 		distro = std::uniform_int_distribution<int>(min, max);
 	}
 
+	// Same as above but repeatable, the same 'seed' always gives the same numbers
+	void Init(int min, int max, uint64_t seed)
+	{
+		std::seed_seq seedSequence{ (uint32_t)seed, (uint32_t)(seed >> 32) };
+		randEngine.seed(seedSequence);
+		distro = std::uniform_int_distribution<int>(min, max);
+	}
+
 	int operator()()
 	{
 		return distro(randEngine);
@@ -24,6 +75,15 @@ private:
 	std::mutex randMutex;
 };
 
+// Derives an independent seed from 'seed' and 'value' (splitmix64)
+uint64_t MixSeed(uint64_t seed, uint64_t value)
+{
+	uint64_t mixed = seed + (value + 1) * 0x9E3779B97F4A7C15ull;
+	mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+	mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBull;
+	return mixed ^ (mixed >> 31);
+}
+
 enum class GameState
 {
 	StillPlaying,
@@ -38,6 +98,34 @@ enum class PlayerType
 	O
 };
 
+// How a wait for the opponent to join a game ended, see WaitForOpponent
+enum WaitPhase
+{
+	// The player arrived second, the opponent was already waiting and nothing was waited for
+	WaitSecondArrival,
+	// It showed up while spinning
+	WaitSpin,
+	// It showed up while yielding the CPU
+	WaitYield,
+	// The player had to go to sleep until it was woken up
+	WaitPark,
+	waitPhaseCount
+};
+
+// How far apart the two players of a turn handoff are pinned, see PlacementPolicy
+enum HandoffDistance
+{
+	// SMT siblings, or the very same CPU
+	HandoffSameCore,
+	// Different cores sharing the last level cache
+	HandoffSameCache,
+	// Different last level caches, possibly different sockets
+	HandoffRemote,
+	// At least one of the two players runs wherever the OS puts it
+	HandoffUnpinned,
+	handoffDistanceCount
+};
+
 enum class LogSyncOperation
 {
 	Init,
@@ -46,70 +134,647 @@ enum class LogSyncOperation
 	Unlock
 };
 
+// Board size and win rule of a game: an N x N board where K in a row wins. Everything
+//   that depends on them is resolved at compile time, so each configuration gets its
+//   own specialized copy of the game loop.
+template <int N, int K>
+struct BoardRules
+{
+	static_assert(K >= 1 && K <= N, "The win length has to fit on the board");
+	static_assert(N * N <= 256, "Moves are stored as one byte per cell");
+
+	static constexpr int size = N;
+	static constexpr int winLength = K;
+	static constexpr int cellCount = N * N;
+	// Boards of up to 64 cells are tracked in integer bitboards with precomputed win masks,
+	//   bigger boards fall back to a bitset and scan outwards from the last move.
+	static constexpr bool hasBitboard = cellCount <= 64;
+
+	using Mask = std::conditional_t<cellCount <= 16, uint16_t,
+		std::conditional_t<cellCount <= 32, uint32_t,
+		std::conditional_t<cellCount <= 64, uint64_t, std::bitset<cellCount>>>>;
+
+	// Returns a mask with only 'cell' (row * N + col) set
+	static Mask CellBit(int cell)
+	{
+		if constexpr (hasBitboard)
+		{
+			return (Mask)((Mask)1 << cell);
+		}
+		else
+		{
+			Mask mask;
+			mask.set(cell);
+			return mask;
+		}
+	}
+};
+
+// The regular 3x3 game. The solver and the game tree table only exist for this one.
+using ClassicRules = BoardRules<3, 3>;
+
+// Every K in a row line through each cell as a bitboard mask, built at compile time.
+//   Only exists for boards that fit in a bitboard.
+template <class Rules>
+struct WinLines
+{
+	using Mask = typename Rules::Mask;
+
+	// A line of K cells in one of the four directions can contain a cell in K different spots
+	static constexpr int maxLinesPerCell = 4 * Rules::winLength;
+
+	struct Table
+	{
+		Mask lines[Rules::cellCount][maxLinesPerCell];
+		int lineCount[Rules::cellCount];
+	};
+
+	static constexpr Table Build()
+	{
+		Table table = {};
+		const int directions[4][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 1, -1 } };
+
+		for (int row = 0; row < Rules::size; row++)
+		{
+			for (int col = 0; col < Rules::size; col++)
+			{
+				for (int d = 0; d < 4; d++)
+				{
+					// Only lines starting at (row, col) so each line is built once
+					int endRow = row + directions[d][0] * (Rules::winLength - 1);
+					int endCol = col + directions[d][1] * (Rules::winLength - 1);
+					if (endRow < 0 || endRow >= Rules::size || endCol < 0 || endCol >= Rules::size)
+						continue;
+
+					Mask line = 0;
+					for (int i = 0; i < Rules::winLength; i++)
+					{
+						line |= (Mask)((Mask)1 << ((row + directions[d][0] * i) * Rules::size + col + directions[d][1] * i));
+					}
+
+					for (int cell = 0; cell < Rules::cellCount; cell++)
+					{
+						if (line & (Mask)((Mask)1 << cell))
+							table.lines[cell][table.lineCount[cell]++] = line;
+					}
+				}
+			}
+		}
+		return table;
+	}
+
+	static constexpr Table table = Build();
+};
+
+template <class Rules>
 struct Game
 {
-	int playerCount;
-	int gameNumber;
+	using Mask = typename Rules::Mask;
+
+	// Position of the current game in the sequence of games played on this entry, -1 before
+	//   the first one. The next game in the sequence is set up by the first player that
+	//   touches it, so starting a new round never sweeps the games. See GameTicket.
+	int64_t ticket;
+	// Number of scheduled players that have arrived at the game. Only changed under
+	//   gameMutex, but a player waiting for its opponent may read it without the mutex.
+	std::atomic<int> playerCount;
+	// Number of players that are done with the game
+	int playersDone;
+	int64_t gameNumber;
 	PlayerType currentTurn;
 	GameState currentGameState;
 	int playerX;
 	int playerO;
-	std::mutex playerCountMutex;
 	// Primary mutex that controls the game play.
 	std::mutex gameMutex;
 	// Primary conditional that controls the game play
 	std::condition_variable gameCondition;
-	// Unique lock which will be constructed with the gameMutex.
-	std::unique_lock<std::mutex>* gameUniqueLock;
-	// A 3x3 array of PlayerTypes that represents the game board.
-	PlayerType gameBoard[3][3];
+	// A NxN array of PlayerTypes that represents the game board.
+	PlayerType gameBoard[Rules::size][Rules::size];
+	// The same board as bit masks, bit (row * N + col) is set for every cell a player owns.
+	Mask xCells;
+	Mask oCells;
+	// Number of cells taken so far
+	int moveCount;
+	// Cell taken by each move so far, 'X' moves first
+	uint8_t moves[Rules::cellCount];
+	// When and from where the last move handed the turn over, only kept for --handoff-stats
+	int64_t turnPassedAt;
+	int passerCpu;
+	int passerCore;
+	int passerCacheDomain;
+};
+
+template <class Rules>
+struct GamePool;
+template <class Rules>
+class MoveStrategy;
+struct PlayerPool;
+
+// How often one position came up and how the games through it ended
+struct PositionCount
+{
+	// Canonical bitboard key on the classic board, a hash of the cells taken on bigger ones
+	uint64_t key;
+	// Moves made to reach the position
+	int64_t ply;
+	int64_t visits;
+	int64_t xWins;
+	int64_t oWins;
+	int64_t draws;
+};
+
+// Position counts of the games one player thread ended. Only that thread writes to it, so
+//   counting needs no atomics or locks; main merges the tables once the threads are done.
+//   The table never grows, positions that don't fit are only counted as dropped.
+class PositionStats
+{
+public:
+	// Entries in the table of each player thread
+	static const size_t playerCapacity = 1 << 12;
+
+	void Init(size_t capacity)
+	{
+		entries.assign(capacity, PositionCount());
+		used = 0;
+		droppedVisits = 0;
+	}
+
+	bool Enabled() const
+	{
+		return !entries.empty();
+	}
+
+	// Counts 'visits' games through the position 'key' that ended with 'winner'
+	void Add(uint64_t key, int64_t ply, int64_t visits, int64_t xWins, int64_t oWins, int64_t draws)
+	{
+		size_t mask = entries.size() - 1;
+		for (size_t i = (size_t)MixSeed(key, (uint64_t)ply) & mask;; i = (i + 1) & mask)
+		{
+			PositionCount& entry = entries[i];
+			if (entry.visits == 0)
+			{
+				// Keep a quarter of the table free so probes stay short
+				if (used >= entries.size() - entries.size() / 4)
+				{
+					droppedVisits += visits;
+					return;
+				}
+				entry.key = key;
+				entry.ply = ply;
+				used++;
+			}
+			else if (entry.key != key || entry.ply != ply)
+			{
+				continue;
+			}
+
+			entry.visits += visits;
+			entry.xWins += xWins;
+			entry.oWins += oWins;
+			entry.draws += draws;
+			return;
+		}
+	}
+
+	void Record(uint64_t key, int64_t ply, PlayerType winner)
+	{
+		Add(key, ply, 1, winner == PlayerType::X, winner == PlayerType::O, winner == PlayerType::None);
+	}
+
+	void Merge(const PositionStats& other)
+	{
+		for (const PositionCount& entry : other.entries)
+		{
+			if (entry.visits > 0)
+				Add(entry.key, entry.ply, entry.visits, entry.xWins, entry.oWins, entry.draws);
+		}
+		droppedVisits += other.droppedVisits;
+	}
+
+	// Power of two number of slots, empty while not collecting
+	std::vector<PositionCount> entries;
+	size_t used;
+	// Visits of positions that no longer fit
+	int64_t droppedVisits;
 };
 
 // Contains all player related data
+template <class Rules>
 struct Player
 {
 	// ID of the player
 	int id;
 	// Number of games this player has played
-	int gamesPlayed;
+	int64_t gamesPlayed;
 	// Number of games this player won
-	int winCount;
+	int64_t winCount;
 	// Number of games this player lost
-	int loseCount;
+	int64_t loseCount;
 	// Number of games this player tied
-	int drawCount;
+	int64_t drawCount;
 	// Type of player this player represents
 	PlayerType type;
+	// Simulation round this player is playing
+	int round;
+	// Number of games this player ended with a winning move
+	int64_t gamesEndedWon;
+	// Number of games this player ended by filling the board
+	int64_t gamesEndedDraw;
+	// Number of games this player ended with a winning move while playing 'X'
+	int64_t gamesEndedWonAsX;
+	// How this player's waits for an opponent ended, indexed by WaitPhase
+	int64_t opponentWaits[waitPhaseCount];
+	// CPU this player's thread is pinned to, -1 when it isn't. See PlacementPolicy.
+	int cpu;
+	int core;
+	int cacheDomain;
+	// Share of the queue's games this player takes from first. See NumaLayout.
+	int node;
+	// Schedule round this player is in, counted across simulation rounds. See StopPlayers.
+	std::atomic<int64_t> schedulePosition;
+	// Games this player finished over the whole run. Only the player writes it, see
+	//   ReportProgress for the reader.
+	std::atomic<int64_t> finishedGames;
+	// Turns handed to this player and how long they took to arrive, indexed by HandoffDistance
+	int64_t handoffs[handoffDistanceCount];
+	int64_t handoffNanoseconds[handoffDistanceCount];
 	// Pointer to the pool of games. See GamePool for more details.
-	struct GamePool* gamePool;
+	GamePool<Rules>* gamePool;
 	// Pointer to the pool of players. See PlayerPool for more details.
 	struct PlayerPool* playerPool;
 	// random number generator for this thread
 	UniformRandInt myRand;
+	// Decides which cell this player takes on each turn. See MoveStrategy for more details.
+	MoveStrategy<Rules>* strategy;
+	// Positions of the games this player ended, when collecting them. See PositionStats.
+	PositionStats positionStats;
+
+};
+
+// How players are paired up for their games
+enum class ScheduleType
+{
+	// Everybody plays everybody in turn, colors swap every cycle
+	RoundRobin,
+	// Players with similar scores meet, each round is paired once the previous one is over
+	Swiss,
+	// Random pairings, byes and colors go to whoever has had the fewest so far
+	RandomBalanced,
+	// No pairings up front, whoever is free plays whoever shows up next. See arrivals.
+	Queue
+};
+
+// Hands out the numbers of one share of the queue's games, see TournamentSchedule::arrivals
+struct alignas(64) ArrivalCounter
+{
+	std::atomic<int64_t> next;
+	// One past the last game of the share
+	int64_t lastGame;
+};
+
+// Largest board whose move sequences fit in a 64-bit code, 20! is just under 2^63
+const int maxMoveCodeCells = 20;
+
+// Packs the order the cells of the board were taken in into one number: the Lehmer code of
+//   the permutation, read as a mixed radix number. Cells that were never taken are appended
+//   in increasing order, which adds nothing to the code, so a game that ended early shares
+//   its code with a full permutation and replaying that until the game is over gives the
+//   game back. Every game on the classic board fits in 19 bits.
+uint64_t EncodeMoveSequence(const uint8_t* moves, int moveCount, int cellCount)
+{
+	uint32_t taken = 0;
+	uint64_t code = 0;
+	for (int i = 0; i < cellCount; i++)
+	{
+		// Rank of the cell among the ones still free, the free cells past the last move rank 0
+		int rank = 0;
+		if (i < moveCount)
+		{
+			for (uint32_t below = ~taken & ((1u << moves[i]) - 1); below; below &= below - 1)
+			{
+				rank++;
+			}
+			taken |= 1u << moves[i];
+		}
+		code = code * (uint64_t)(cellCount - i) + (uint64_t)rank;
+	}
+	return code;
+}
+
+// Undoes EncodeMoveSequence, stores all 'cellCount' cells in the order they are taken
+void DecodeMoveSequence(uint64_t code, int cellCount, uint8_t* cells)
+{
+	int ranks[maxMoveCodeCells];
+	for (int i = cellCount - 1; i >= 0; i--)
+	{
+		ranks[i] = (int)(code % (uint64_t)(cellCount - i));
+		code /= (uint64_t)(cellCount - i);
+	}
+
+	uint32_t taken = 0;
+	for (int i = 0; i < cellCount; i++)
+	{
+		int cell = 0;
+		for (int rank = ranks[i];; cell++)
+		{
+			if ((taken & (1u << cell)) == 0 && rank-- == 0)
+				break;
+		}
+		cells[i] = (uint8_t)cell;
+		taken |= 1u << cell;
+	}
+}
+
+// Outcome of a single game, as stored for later processing
+struct GameOutcome
+{
+	int32_t playerX;
+	int32_t playerO;
+	// PlayerType of the winner, None for a draw
+	uint8_t winner;
+	// Classic board only, the 24 low bits of EncodeMoveSequence for the game's moves. Zero
+	//   on every other board.
+	uint8_t moveCode[3];
+};
+
+uint32_t OutcomeMoveCode(const GameOutcome& outcome)
+{
+	return outcome.moveCode[0] | (outcome.moveCode[1] << 8) | (outcome.moveCode[2] << 16);
+}
+
+// Games left out when a round is stopped early keep the all zero record they start with,
+//   which no game can produce since a player never plays itself
+bool OutcomeWasPlayed(const GameOutcome& outcome)
+{
+	return outcome.playerX != 0 || outcome.playerO != 0 || outcome.winner != 0 || OutcomeMoveCode(outcome) != 0;
+}
+
+// Checks a record read back from a results file: two different players of the run and a
+//   winner that is one of them or nobody
+bool OutcomeIsValid(const GameOutcome& outcome, int playerCount)
+{
+	return outcome.playerX != outcome.playerO && outcome.playerX >= 0 && outcome.playerX < playerCount &&
+		outcome.playerO >= 0 && outcome.playerO < playerCount && outcome.winner <= (uint8_t)PlayerType::O;
+}
+
+// Precomputed pairings for a whole round of games. The tournament is split into schedule
+//   rounds in which every player plays at most one game. The entry for player p in
+//   schedule round r is slots[r * playerCount + p]: (game index * 2) + 1 when the player
+//   is 'X', (game index * 2) when the player is 'O' and -1 for a bye. Every player only
+//   reads its own entries, so handing out games needs no locking at all. When streaming
+//   nothing is stored, the entries are worked out from the round number on demand. A short
+//   last schedule round goes to the players with the fewest games so far, so the game
+//   counts of the players differ by at most one.
+struct TournamentSchedule
+{
+	ScheduleType type;
+	int playerCount;
+	int64_t totalGameCount;
+	// Games in a full schedule round, one for every two players
+	int gamesPerRound;
+	int64_t roundCount;
+	// Round robin only. Compute each entry when it's needed instead of storing them all,
+	//   the games of one schedule round are then the only games that exist.
+	bool streaming;
+	std::vector<int64_t> slots;
+
+	// Number of schedule rounds that have been paired so far. Only Swiss pairs rounds
+	//   while the games are being played, everything else is paired up front.
+	int64_t pairedRounds;
+	std::mutex pairingMutex;
+	std::condition_variable pairingCondition;
+	// Swiss only. Games still being played in each round, and the score of each player in
+	//   half points (a win is 2, a draw is 1).
+	std::unique_ptr<std::atomic<int>[]> gamesLeftInRound;
+	std::unique_ptr<std::atomic<int>[]> halfPoints;
+
+	// Queue only. Every player looking for a game takes the next number: numbers 2g and
+	//   2g + 1 play game g as 'X' and 'O'. A single atomic add is all the matchmaking there is,
+	//   whoever takes an even number is the one waiting and the next player to come along
+	//   is its opponent. With the games split between NUMA nodes every node hands out its
+	//   own share from its own counter, to its own players only.
+	std::unique_ptr<ArrivalCounter[]> arrivals;
+
+	// When set, the player that ends a game stores its outcome here. Game g of simulation
+	//   round r goes to r * totalGameCount + g.
+	GameOutcome* outcomes;
 
+	// Balancing information used while pairing
+	std::vector<int> xGames;
+	std::vector<int> games;
+	std::vector<int> byes;
+	std::vector<int> lastOpponent;
+	std::mt19937 shuffleEngine;
 };
 
 // Holds all of the games
+template <class Rules>
 struct GamePool
 {
-	// An array of game specific data with exactly one entry for each game. See Game for more details.
-	Game* perGameData;
-	// Total number of games and the number of entries in perGameData
-	int totalGameCount;
+	// An array of game specific data. See Game for more details.
+	Game<Rules>* perGameData;
+	// Total number of games in a round
+	int64_t totalGameCount;
+	// Number of entries in perGameData. One per game, or one per table when streaming.
+	int64_t gameSlotCount;
+	// Which games every player plays. See TournamentSchedule for more details.
+	TournamentSchedule* schedule;
+};
+
+// Round totals. Each player thread merges its partial sums into the pool's
+//   copy right before it exits, so the totals are complete once main wakes up.
+struct RoundTotals
+{
+	int64_t totalGamesWon;
+	int64_t totalGamesWonByX;
+	int64_t totalGamesTied;
+	int64_t totalPlayerWins;
+	int64_t totalPlayerLoses;
+	int64_t totalPlayerTies;
+	// Data TLB load misses of the player threads, when counting them was requested
+	uint64_t dtlbLoadMisses;
+	// How the waits for an opponent ended, indexed by WaitPhase
+	int64_t opponentWaits[waitPhaseCount];
+	// Turn handoffs and their total latency, indexed by HandoffDistance
+	int64_t handoffs[handoffDistanceCount];
+	int64_t handoffNanoseconds[handoffDistanceCount];
+	// Number of player threads that could not count their TLB misses
+	int tlbCountersUnavailable;
+};
+
+// Results of one player in one round, copied out when the player finishes the round
+struct PlayerRoundResult
+{
+	int64_t gamesPlayed;
+	int64_t winCount;
+	int64_t loseCount;
+	int64_t drawCount;
+};
+
+// Everything reported about a single round
+struct RoundResults
+{
+	RoundTotals totals;
+	// Number of player threads that have merged their results for this round
+	int playersFinished;
+	std::vector<PlayerRoundResult> players;
+};
+
+// Which pages back the simulation arena
+enum class HugePageMode
+{
+	// Regular 4K pages
+	Off,
+	// Ask the OS to back the arena with transparent huge pages (Linux only)
+	Transparent,
+	// Explicit 2MB huge pages, falls back to regular pages if none are available
+	Explicit
+};
+
+// Where the player threads run
+enum class PlacementPolicy
+{
+	// Wherever the OS puts them
+	None,
+	// Players fill the SMT siblings of a core, then the cores sharing its last level cache,
+	//   before moving on to the next cache, so opponents are as close as they can be
+	Compact,
+	// One player per core across every cache before any core gets a second one
+	Spread
+};
+
+// Which NUMA node the memory of the players and games comes from
+enum class NumaMode
+{
+	// Wherever it is first touched
+	Off,
+	// The queue's games are split between the nodes the players are pinned to, each share
+	//   is first touched on its node and played by the players of that node
+	Local,
+	// Pages go round robin over all nodes, as the baseline to compare Local against
+	Interleave
+};
+
+// Settings that can be changed from the command line
+struct SimulationSettings
+{
+	// Suppresses per-move logging, board printing and the per-game result listing
+	bool quiet;
+	// Strategy names handed out to the players in turn, e.g. "perfect,random"
+	std::string strategies;
+	// Width and height of the board
+	int boardSize;
+	// Number of cells in a row needed to win
+	int winLength;
+	// Playouts per move for the MCTS strategy, used when no time budget is set
+	int mctsPlayouts;
+	// Time budget per move for the MCTS strategy in milliseconds, 0 to use the playout budget
+	int mctsTimeMs;
+	// Number of threads each MCTS search uses
+	int mctsThreads;
+	// Leaf parallelization instead of root parallelization for the MCTS strategy
+	bool mctsLeafParallel;
+	// How players are paired up
+	ScheduleType scheduleType;
+	// Elo K-factor
+	double eloKFactor;
+	// Page size backing the players and games. See SimulationArena for more details.
+	HugePageMode hugePages;
+	// Construct the games from several threads so each thread's pages are local to it
+	bool parallelFirstTouch;
+	// Count data TLB misses of the player threads
+	bool tlbStats;
+	// Rounds a player spins and then yields while waiting for its opponent before it goes to
+	//   sleep. -1 picks them from the number of player threads per core, see ResolveWaitPolicy.
+	int waitSpins;
+	int waitYields;
+	// Show how the waits for an opponent ended
+	bool waitStats;
+	// CPUs the player threads are pinned to
+	PlacementPolicy placement;
+	// Time how long each turn takes to reach the opponent
+	bool handoffStats;
+	// Where the memory of the players and games comes from
+	NumaMode numa;
+	// Seconds the run may take before it stops where it is, 0 for no limit
+	double timeLimit;
+	// Seconds between two progress reports, 0 for none
+	double progressInterval;
+	// Rounds to play back to back without asking, 0 to ask after every round
+	int roundCount;
+	// Generate games as they are reached instead of allocating all of them up front
+	bool streamGames;
+	// Worker processes each round's games are split between, 1 to play them all in this process
+	int processCount;
+	// Unix socket the batch coordinator listens on, or a batch worker connects to
+	std::string socketPath;
+	// Run as a batch worker instead of a coordinator
+	bool batchWorker;
+	// Batch workers the coordinator starts itself, more can connect at any time
+	int batchWorkerCount;
+	// File the progress of the run is saved to, empty to not save it
+	std::string checkpointPath;
+	// Games played between two checkpoints
+	int64_t checkpointGames;
+	// Continue the run saved in checkpointPath
+	bool resume;
+	// Every batch seed of the run is derived from this one. Random unless given.
+	uint64_t runSeed;
+	bool runSeedGiven;
+	// File the outcome of every game is written to, empty to not write one. See ResultsFileHeader.
+	std::string resultsPath;
+	// Results file to report on instead of running a simulation
+	std::string analyzePath;
+	// Results file whose games are replayed and checked instead of running a simulation
+	std::string replayPath;
+	// Threads the replay is split between, 0 for one per hardware thread
+	int replayThreads;
+	// File the position counts are exported to, empty to not count positions
+	std::string positionStatsPath;
+	// Moves into each game whose positions are counted
+	int positionStatsDepth;
+};
+
+SimulationSettings simulationSettings;
+
+// Elo rating of every player. Ratings are kept in thousandths of a point so the game
+//   threads can update them with an atomic add instead of a lock. They carry over from
+//   one round to the next.
+struct RatingTable
+{
+	int playerCount;
+	// How far a single game can move a rating
+	double kFactor;
+	// Points at ownedMilliRatings, or into shared memory when worker processes play the games
+	std::atomic<int64_t>* milliRatings;
+	std::unique_ptr<std::atomic<int64_t>[]> ownedMilliRatings;
+	// Ratings when the current round started, to show how much each player moved
+	std::vector<int64_t> roundStartMilliRatings;
 };
 
 // Stores data for keeping track of the total number of player threads
 struct PlayerPool
 {
 	int totalPlayerCount;
+	// Rating of every player. See RatingTable for more details.
+	RatingTable* ratings;
+	// Results of every round so far, indexed by round number. Only resized while no
+	//   player threads are running.
+	std::vector<RoundResults> roundResults;
 	std::mutex totalPlayersMutex;
-	std::mutex startingGunMutex;
 	std::mutex playersIncrementMutex;
 	std::mutex playersDecrementMutex;
 	std::condition_variable playerCondition;
 	std::condition_variable playerIncrementCondition;
 	std::condition_variable playerDecrementCondition;
 	bool gunFlag;
+	// Set once the run is asked to stop early, see StopPlayers
+	std::atomic<bool> stopRequested;
+	// First schedule position that is left out, -1 until it has been worked out
+	std::atomic<int64_t> stopPosition;
+	// When the run is out of time, with a time limit
+	std::chrono::steady_clock::time_point deadline;
 };
 
 // Prompts the user to press enter and waits for user input
@@ -121,9 +786,19 @@ void Pause()
 
 void LogSync(LogSyncOperation operationToPerform)
 {
-	// Implement 'LogSync' logic. (To be used later on)
 	static std::mutex logMutex;
-	std::lock_guard<std::mutex> lock(logMutex);
+
+	switch (operationToPerform)
+	{
+	case LogSyncOperation::Lock:
+		logMutex.lock();
+		break;
+	case LogSyncOperation::Unlock:
+		logMutex.unlock();
+		break;
+	default:
+		break;
+	}
 }
 
 // Prints a formatted string to the standard output in a thread safe manner. 
@@ -131,470 +806,5164 @@ int Log(const char* format, ...)
 {
 	int result = 0;
 
-	// Implement 'Log' logic. This function behaves exactly like printf,
+	// This function behaves exactly like printf
+	va_list args;
+	va_start(args, format);
 	LogSync(LogSyncOperation::Lock);
-	printf(format);
+	result = vprintf(format, args);
 	LogSync(LogSyncOperation::Unlock);
+	va_end(args);
 
 	return result;
 }
 
-// Prints the current game board to the console
-void PrintGameBoard(const Game* currentGame)
+// Same as Log, but prints nothing when running quiet
+int LogVerbose(const char* format, ...)
 {
-	// Prints the game board to the screen as a single block of text
-	LogSync(LogSyncOperation::Lock);
+	int result = 0;
 
-	for (int row = 0; row < 3; row++)
-	{
-		for (int col = 0; col < 3; col++)
-		{
-			if (currentGame->gameBoard[row][col] == PlayerType::None)
-			{
-				printf("[ ]");
-			}
-			else
-			{
-				printf("[%c]", (currentGame->gameBoard[row][col] == PlayerType::X) ? 'X' : 'O');
-			}
-			std::this_thread::yield();
-		}
-		printf("\n");
-	}
+	if (simulationSettings.quiet)
+		return result;
+
+	va_list args;
+	va_start(args, format);
+	LogSync(LogSyncOperation::Lock);
+	result = vprintf(format, args);
 	LogSync(LogSyncOperation::Unlock);
+	va_end(args);
+
+	return result;
 }
 
-// Determines if the player made a winning move on the game board
-bool DidWeWin(int row, int col, const Game* game, const Player* player)
+// A single block of memory holding the players and games of a simulation. One allocation
+//   instead of thousands keeps the objects packed together, and the block can be backed
+//   by 2MB pages so far fewer TLB entries are needed to cover it.
+struct SimulationArena
 {
-	bool completeRow = true;
-	bool completeCol = true;
-	bool completeDiagonalA = true;
-	bool completeDiagonalB = true;
-
-	// Check specified row, column, and both diagonals to see if this player made
-	//  a winning move.
-	for (int i = 0; i < 3; i++)
-	{
-		if (game->gameBoard[row][i] != player->type)
-			completeRow = false;
-		if (game->gameBoard[i][col] != player->type)
-			completeCol = false;
-		if (game->gameBoard[i][i] != player->type)
-			completeDiagonalA = false;
-		if (game->gameBoard[2 - i][i] != player->type)
-			completeDiagonalB = false;
-	}
+	char* base;
+	size_t capacity;
+	size_t used;
+	// Size of the actual mapping, rounded up to the page size
+	size_t mappedBytes;
+	// What the block ended up being backed by
+	const char* backing;
+	bool largePages;
+};
 
-	return completeRow || completeCol || completeDiagonalA || completeDiagonalB;
-}
+const size_t hugePageSize = 2 * 1024 * 1024;
 
-// Play the entire game of Tic-Tac-Toe as 'currentPlayer' in 'currentGame'
-GameState MakeAMove(Player* currentPlayer, Game* currentGame)
+// Reserves 'bytes' for the arena, backed by the pages 'mode' asks for where possible.
+//   Nothing is touched here, so every page is placed by whoever writes it first.
+bool ArenaReserve(SimulationArena* arena, size_t bytes, HugePageMode mode)
 {
-	int possibleMoves[9];
-	int totalPossibleMoves = 0;
+	arena->capacity = bytes;
+	arena->used = 0;
+	arena->largePages = false;
+	arena->mappedBytes = (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
 
-	// Find all valid moves this player can make
-	for (int row = 0; row < 3; row++)
+#if defined(_WIN32)
+	if (mode == HugePageMode::Explicit && GetLargePageMinimum() != 0)
 	{
-		for (int col = 0; col < 3; col++)
+		// Needs the 'Lock pages in memory' privilege, fall back to regular pages without it
+		size_t largePage = GetLargePageMinimum();
+		size_t largeBytes = (bytes + largePage - 1) / largePage * largePage;
+		arena->base = (char*)VirtualAlloc(nullptr, largeBytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (arena->base)
 		{
-			if (currentGame->gameBoard[row][col] == PlayerType::None)
-			{
-				possibleMoves[totalPossibleMoves++] = (row * 3) + col;
-			}
+			arena->mappedBytes = largeBytes;
+			arena->backing = "large pages";
+			arena->largePages = true;
+			return true;
 		}
+		Log("Large pages are not available, using regular pages\n");
 	}
 
-	if (totalPossibleMoves != 0)
+	arena->base = (char*)VirtualAlloc(nullptr, arena->mappedBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	arena->backing = "regular pages";
+	return arena->base != nullptr;
+#elif defined(__linux__)
+	if (mode == HugePageMode::Explicit)
 	{
-		// There are valid moves left on the board, pick a random valid location
-		int randomMoveIndex = currentPlayer->myRand() % totalPossibleMoves;
+		void* mapping = mmap(nullptr, arena->mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (mapping != MAP_FAILED)
+		{
+			arena->base = (char*)mapping;
+			arena->backing = "explicit 2MB huge pages";
+			arena->largePages = true;
+			return true;
+		}
+		Log("No explicit huge pages are reserved (see /proc/sys/vm/nr_hugepages), trying transparent huge pages\n");
+		mode = HugePageMode::Transparent;
+	}
 
-		int row = possibleMoves[randomMoveIndex] / 3;
-		int col = possibleMoves[randomMoveIndex] % 3;
-		currentGame->gameBoard[row][col] = currentPlayer->type;
+	void* mapping = mmap(nullptr, arena->mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapping == MAP_FAILED)
+		return false;
 
-		Log("Game %d: Player %d: Picked [Row: %d, Col: %d]\n", currentGame->gameNumber, currentPlayer->id, row, col);
+	arena->base = (char*)mapping;
+	arena->backing = "regular pages";
+	if (mode == HugePageMode::Transparent && madvise(mapping, arena->mappedBytes, MADV_HUGEPAGE) == 0)
+	{
+		arena->backing = "transparent huge pages";
+		arena->largePages = true;
+	}
+	return true;
+#else
+	arena->base = (char*)std::malloc(arena->mappedBytes);
+	arena->backing = "regular pages";
+	return arena->base != nullptr;
+#endif
+}
 
-		if (DidWeWin(row, col, currentGame, currentPlayer))
-		{
-			Log("Game %d:Player %d - Won\n", currentGame->gameNumber, currentPlayer->id);
-			currentPlayer->winCount++;
+// Carves 'bytes' out of the arena
+void* ArenaAllocate(SimulationArena* arena, size_t bytes, size_t alignment)
+{
+	size_t offset = (arena->used + alignment - 1) / alignment * alignment;
+	if (offset + bytes > arena->capacity)
+		return nullptr;
 
-			return GameState::Won;
-		}
-		else
+	arena->used = offset + bytes;
+	return arena->base + offset;
+}
+
+void ArenaRelease(SimulationArena* arena)
+{
+#if defined(_WIN32)
+	VirtualFree(arena->base, 0, MEM_RELEASE);
+#elif defined(__linux__)
+	munmap(arena->base, arena->mappedBytes);
+#else
+	std::free(arena->base);
+#endif
+	arena->base = nullptr;
+}
+
+// Counts the data TLB load misses of the calling thread. Only Linux exposes the counter,
+//   everywhere else Open() fails and nothing is counted.
+struct TlbCounter
+{
+	int fd = -1;
+
+	bool Open()
+	{
+#if defined(__linux__)
+		perf_event_attr attributes;
+		memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.type = PERF_TYPE_HW_CACHE;
+		attributes.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+
+		fd = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+#endif
+		return fd != -1;
+	}
+
+	uint64_t ReadAndClose()
+	{
+		uint64_t count = 0;
+#if defined(__linux__)
+		if (fd != -1)
 		{
-			return GameState::StillPlaying;
+			if (read(fd, &count, sizeof(count)) != sizeof(count))
+				count = 0;
+			close(fd);
+			fd = -1;
 		}
+#endif
+		return count;
 	}
+};
 
-	// There are no more moves left, game resulted in a draw.
-	Log("Game %d:Player %d - Draw\n", currentGame->gameNumber, currentPlayer->id);
-	currentPlayer->drawCount++;
+// A CPU the player threads may be pinned to
+struct CpuPlace
+{
+	int cpu;
+	// Physical core, the same for SMT siblings
+	int core;
+	// Same for every CPU behind one last level cache
+	int cacheDomain;
+	// NUMA node of the CPU
+	int node;
+};
 
-	return GameState::Draw;
+// Reads the number in a sysfs file, -1 when there is none
+int ReadSysfsNumber(const std::string& path)
+{
+	int value = -1;
+	FILE* file = fopen(path.c_str(), "r");
+	if (file != nullptr)
+	{
+		if (fscanf(file, "%d", &value) != 1)
+			value = -1;
+		fclose(file);
+	}
+	return value;
 }
 
-// Play the entire game of Tic-Tac-Toe as 'currentPlayer' in 'currentGame'
-void PlayGame(Player* currentPlayer, Game* currentGame)
+// Sorts 'places' into the order 'policy' hands them out to players
+std::vector<CpuPlace> OrderCpuPlaces(std::vector<CpuPlace> places, PlacementPolicy policy)
 {
-	Log("Game %d:Player %d vs Player %d (Player %d) starting\n", currentGame->gameNumber, currentGame->playerX, currentGame->playerO, currentPlayer->id);
+	// Compact is siblings first, then the cores of a cache, then the next cache
+	std::sort(places.begin(), places.end(), [](const CpuPlace& a, const CpuPlace& b)
+		{ return (a.cacheDomain != b.cacheDomain) ? a.cacheDomain < b.cacheDomain : (a.core != b.core) ? a.core < b.core : a.cpu < b.cpu; });
+	if (policy == PlacementPolicy::Compact)
+		return places;
 
-	if (currentGame->playerO == -1 || currentGame->playerX == -1)
+	// Spread deals out the first sibling of every core, one cache at a time, then the second ones
+	std::vector<int> siblingRank(places.size());
+	std::vector<int> coreRank(places.size());
+	std::vector<int> cacheRank(places.size());
+	for (size_t i = 0; i < places.size(); i++)
 	{
-		Log("ERROR: Playing game with only one player present. Did you forget to wait for the second player in JoinGame()?\n");
-		Pause();
-		exit(1);
+		bool sameCache = i > 0 && places[i].cacheDomain == places[i - 1].cacheDomain;
+		bool sameCore = sameCache && places[i].core == places[i - 1].core;
+		siblingRank[i] = sameCore ? siblingRank[i - 1] + 1 : 0;
+		coreRank[i] = sameCore ? coreRank[i - 1] : sameCache ? coreRank[i - 1] + 1 : 0;
+		cacheRank[i] = (i == 0) ? 0 : sameCache ? cacheRank[i - 1] : cacheRank[i - 1] + 1;
 	}
 
-	while (currentGame->currentGameState == GameState::StillPlaying)
+	std::vector<size_t> order(places.size());
+	for (size_t i = 0; i < order.size(); i++)
 	{
-		if (currentGame->currentTurn != currentPlayer->type)
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
 		{
-			Log("ERROR: Wrong player is playing. You broke it.\n");
-			Pause();
-			exit(1);
-		}
-
-		currentGame->currentTurn = (currentPlayer->type == PlayerType::X) ? PlayerType::O : PlayerType::X;
+			if (siblingRank[a] != siblingRank[b])
+				return siblingRank[a] < siblingRank[b];
+			if (coreRank[a] != coreRank[b])
+				return coreRank[a] < coreRank[b];
+			return cacheRank[a] < cacheRank[b];
+		});
 
-		// Make a move on the game board
-		currentGame->currentGameState = MakeAMove(currentPlayer, currentGame);
-		PrintGameBoard(currentGame);
+	std::vector<CpuPlace> spread;
+	for (size_t i : order)
+	{
+		spread.push_back(places[i]);
+	}
+	return spread;
+}
 
-		switch (currentGame->currentGameState)
-		{
-		case GameState::StillPlaying:
+// Lists the CPUs this process may run on. Linux reads the cores, last level caches and
+//   nodes from sysfs. Windows only gets the CPUs and their nodes, each CPU counted as a
+//   core of its own behind one shared cache.
+std::vector<CpuPlace> ListCpuPlaces()
+{
+	std::vector<CpuPlace> places;
 
-			// The game is not over yet. 
-			currentGame->gameCondition.notify_all();
-			currentGame->gameCondition.wait(*currentGame->gameUniqueLock);
+#if defined(__linux__)
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+		return places;
 
+	for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+	{
+		if (!CPU_ISSET(cpu, &allowed))
 			continue;
 
-		case GameState::Won:
-			// We have won the game
-			currentGame->gameCondition.notify_all();
+		// Without a core or cache id every CPU is a core of its own and the socket is the cache
+		std::string directory = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/";
+		int package = std::max(ReadSysfsNumber(directory + "topology/physical_package_id"), 0);
+		int coreId = ReadSysfsNumber(directory + "topology/core_id");
+		int cacheId = ReadSysfsNumber(directory + "cache/index3/id");
 
-			return;
+		// The node shows up as a 'node<id>' entry in the CPU's directory
+		int node = 0;
+		DIR* entries = opendir(directory.c_str());
+		for (dirent* entry = entries ? readdir(entries) : nullptr; entry != nullptr; entry = readdir(entries))
+		{
+			if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9')
+				node = atoi(entry->d_name + 4);
+		}
+		if (entries != nullptr)
+			closedir(entries);
 
-		case GameState::Draw:
-
-			// The game ended in a tie
-			currentGame->gameCondition.notify_all();
-
-			return;
-		}
+		CpuPlace place;
+		place.cpu = cpu;
+		place.core = (coreId >= 0) ? (package << 16 | coreId) : -1 - cpu;
+		place.cacheDomain = package << 16 | std::max(cacheId, 0);
+		place.node = node;
+		places.push_back(place);
 	}
+#elif defined(_WIN32)
+	DWORD_PTR processMask;
+	DWORD_PTR systemMask;
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+		return places;
 
-	// Only one player will execute this logic. The winning/Tied player will exit this function
-	//   upon finding out the game is over.
-	if (currentGame->currentGameState == GameState::Won)
-	{
-		Log("Game %d:Player %d - Lost\n", currentGame->gameNumber, currentPlayer->id);
-		(currentPlayer->loseCount)++;
-	}
-	else if (currentGame->currentGameState == GameState::Draw)
+	for (int cpu = 0; cpu < (int)sizeof(DWORD_PTR) * 8; cpu++)
 	{
-		Log("Game %d:Player %d - Draw\n", currentGame->gameNumber, currentPlayer->id);
-		(currentPlayer->drawCount)++; // count draw
+		UCHAR node = 0;
+		if (processMask & ((DWORD_PTR)1 << cpu))
+			places.push_back({ cpu, cpu, 0, GetNumaProcessorNode((UCHAR)cpu, &node) ? (int)node : 0 });
 	}
+#endif
+
+	return places;
 }
 
-// Makes 'currentPlayer' join 'currentGame' and either waits for another player to
-//  join or begins playing the game if both players are now present.
-void JoinGame(Player* currentPlayer, Game* currentGame)
+// Lists the CPUs this process may run on in the order 'policy' hands them out to players
+std::vector<CpuPlace> PlacementOrder(PlacementPolicy policy)
 {
-	// The player thread has joined a game and will begin playing it now.
-	std::unique_lock<std::mutex> gameUniqueLock(currentGame->gameMutex);
-	currentGame->gameUniqueLock = &gameUniqueLock;
+	if (policy == PlacementPolicy::None)
+		return std::vector<CpuPlace>();
+	return OrderCpuPlaces(ListCpuPlaces(), policy);
+}
+
+// Pins 'thread' to 'cpu', returns false when the OS wouldn't
+bool PinThread(std::thread& thread, int cpu)
+{
+#if defined(__linux__)
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+	return pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus) == 0;
+#elif defined(_WIN32)
+	return SetThreadAffinityMask((HANDLE)thread.native_handle(), (DWORD_PTR)1 << cpu) != 0;
+#else
+	return false;
+#endif
+}
+
+// Same for the calling thread
+bool PinCurrentThread(int cpu)
+{
+#if defined(__linux__)
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#elif defined(_WIN32)
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#else
+	return false;
+#endif
+}
+
+// How the games are split between NUMA nodes with --numa local. Every node the players are
+//   pinned to gets a share of the games in proportion to its players, first touched by a
+//   thread on that node, and its players only play the games of their own share. Nodes are
+//   numbered 0 and up here, in the order of their ids.
+struct NumaLayout
+{
+	// Ids of the nodes in use, the node of every allowed CPU when interleaving
+	std::vector<int> nodes;
+	// A CPU on every node for the thread that constructs its games
+	std::vector<int> nodeCpus;
+	// Players on the nodes before each node, with the total at the end. Empty when the
+	//   games are not split.
+	std::vector<int> playerStarts;
 
-	if (currentGame->playerO == -1)
+	bool SplitsGames() const
 	{
-		Log("Player %d joining game %d as 'O'\n", currentPlayer->id, currentGame->gameNumber);
+		return !playerStarts.empty();
+	}
 
-		currentGame->playerO = currentPlayer->id;
-		currentPlayer->type = PlayerType::O;
+	// First game of the share of 'node' when there are 'gameCount' games
+	int64_t FirstGame(int node, int64_t gameCount) const
+	{
+		return gameCount * playerStarts[node] / playerStarts.back();
+	}
+};
 
-		// Wait for other player to join the game
-		currentGame->gameCondition.wait(gameUniqueLock, [&]
-			{return currentGame->playerX != -1; });
+NumaLayout numaLayout;
 
+// Splits the games between the nodes of the CPUs in 'playerPlaces', player i runs on entry
+//   i modulo its size. Returns false and leaves the games whole when a node would end up with
+//   a single player, nobody could ever take the other half of its games.
+bool BuildNumaLayout(NumaLayout* layout, const std::vector<CpuPlace>& playerPlaces, int totalPlayerCount)
+{
+	layout->nodes.clear();
+	layout->nodeCpus.clear();
+	layout->playerStarts.clear();
+	for (int i = 0; i < totalPlayerCount && i < (int)playerPlaces.size(); i++)
+	{
+		layout->nodes.push_back(playerPlaces[i].node);
 	}
-	else
+	std::sort(layout->nodes.begin(), layout->nodes.end());
+	layout->nodes.erase(std::unique(layout->nodes.begin(), layout->nodes.end()), layout->nodes.end());
+
+	std::vector<int> playerCounts(layout->nodes.size(), 0);
+	layout->nodeCpus.assign(layout->nodes.size(), -1);
+	for (int i = 0; i < totalPlayerCount; i++)
 	{
-		Log("Player %d joining game %d as 'X'\n", currentPlayer->id, currentGame->gameNumber);
+		const CpuPlace& place = playerPlaces[i % playerPlaces.size()];
+		int node = (int)(std::lower_bound(layout->nodes.begin(), layout->nodes.end(), place.node) - layout->nodes.begin());
+		playerCounts[node]++;
+		layout->nodeCpus[node] = place.cpu;
+	}
 
-		currentGame->playerX = currentPlayer->id;
-		currentPlayer->type = PlayerType::X;
+	for (int count : playerCounts)
+	{
+		if (count < 2)
+			return false;
 	}
 
-	PlayGame(currentPlayer, currentGame);
-	currentGame->gameUniqueLock = nullptr;
-	currentPlayer->gamesPlayed++;
-	gameUniqueLock.unlock();
+	layout->playerStarts.push_back(0);
+	for (int count : playerCounts)
+	{
+		layout->playerStarts.push_back(layout->playerStarts.back() + count);
+	}
+	return true;
 }
-// Makes the specified player try to sequentially join and play each game in the
-//   pool of games.
-void TryToPlayEachGame(Player* currentPlayer)
+
+// Index of 'place's node in 'layout', 0 when the games are not split
+int NumaNodeIndex(const NumaLayout* layout, const CpuPlace& place)
 {
-	Log("Player %d starting to play games...\n", currentPlayer->id);
+	if (!layout->SplitsGames())
+		return 0;
+	return (int)(std::lower_bound(layout->nodes.begin(), layout->nodes.end(), place.node) - layout->nodes.begin());
+}
 
-	Game* listOfGames = currentPlayer->gamePool->perGameData;
-	int totalGameCount = currentPlayer->gamePool->totalGameCount;
+// Spreads the arena's pages round robin over the nodes in 'layout' instead of placing each
+//   one where it is first touched. Has to come before anything is written. Linux only.
+bool ArenaInterleave(SimulationArena* arena, const NumaLayout* layout)
+{
+#if defined(__linux__)
+	unsigned long nodeMask[4] = {};
+	const int wordBits = (int)(sizeof(unsigned long) * 8);
+	const int maskBits = (int)(sizeof(nodeMask) * 8);
+	for (int node : layout->nodes)
+	{
+		if (node < maskBits)
+			nodeMask[node / wordBits] |= 1ul << (node % wordBits);
+	}
+	return syscall(SYS_mbind, arena->base, arena->mappedBytes, MPOL_INTERLEAVE, nodeMask, maskBits + 1, 0) == 0;
+#else
+	(void)arena;
+	(void)layout;
+	return false;
+#endif
+}
 
-	// All of our player threads will be going through the pool of games looking for the any
-	//   games that aren't full. The player will join and play any non-full games it finds while
-	//   iterating through the list of games.
-	for (int i = 0; i < totalGameCount; i++)
+const char* PlacementPolicyName(PlacementPolicy policy)
+{
+	switch (policy)
 	{
-		// Checks to see if we can join this game
-		listOfGames[i].playerCountMutex.lock();
-		if (listOfGames[i].playerCount == 2)
-		{
-			// Game is full, skip it
-			listOfGames[i].playerCountMutex.unlock();
-			continue;
-		}
+	case PlacementPolicy::Compact:
+		return "compact";
+	case PlacementPolicy::Spread:
+		return "spread";
+	default:
+		return "none";
+	}
+}
+
+// Shared memory the worker processes of a sharded run report into: one block of results
+//   per worker, followed by the rating of every player which all workers update in place.
+//   Only Linux can fork the workers, everywhere else creating the region fails.
+struct ShardRegion
+{
+	char* base;
+	size_t bytes;
+	int shardCount;
+	int playerCount;
+	// Bytes from the results of one worker to the next
+	size_t shardStride;
+};
 
-		// This game wasn't full so we will join it
-		listOfGames[i].playerCount++;
-		listOfGames[i].playerCountMutex.unlock();
+// Ratings are updated from several processes at once, which only works for atomics that
+//   don't fall back to a lock inside the process
+static_assert(std::atomic<int64_t>::is_always_lock_free, "Shared ratings need lock-free 64-bit atomics");
 
-		// We joined the game so we can start playing it
-		JoinGame(currentPlayer, &listOfGames[i]);
-	}
+bool ShardRegionCreate(ShardRegion* region, int shardCount, int playerCount)
+{
+	const size_t cacheLineSize = 64;
+	region->shardCount = shardCount;
+	region->playerCount = playerCount;
+	region->shardStride = (sizeof(RoundTotals) + sizeof(PlayerRoundResult) * playerCount + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+	region->bytes = region->shardStride * shardCount + sizeof(std::atomic<int64_t>) * playerCount;
+	region->base = nullptr;
+
+#if defined(__linux__)
+	std::string name = "/TicTacToeRandomizer-" + std::to_string(getpid());
+	int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd == -1)
+		return false;
+
+	// The mapping outlives the name, so unlink right away and nothing is left behind
+	//   should the run die
+	void* mapping = MAP_FAILED;
+	if (ftruncate(fd, (off_t)region->bytes) == 0)
+		mapping = mmap(nullptr, region->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	shm_unlink(name.c_str());
+
+	if (mapping == MAP_FAILED)
+		return false;
+
+	region->base = (char*)mapping;
+	return true;
+#else
+	return false;
+#endif
 }
 
-// Entry point for player threads. 
-void PlayerThreadEntrypoint(Player* currentPlayer)
+RoundTotals* ShardTotals(const ShardRegion* region, int shard)
 {
-	Log("Player %d waiting on starting gun\n", currentPlayer->id);
+	return (RoundTotals*)(region->base + region->shardStride * shard);
+}
 
-	// Let main know there's one more player thread running then wait for a notification from main.
-	currentPlayer->playerPool->playersIncrementMutex.lock();
-	currentPlayer->playerPool->totalPlayerCount++;
-	currentPlayer->playerPool->playersIncrementMutex.unlock();
-	currentPlayer->playerPool->playerCondition.notify_all();
+PlayerRoundResult* ShardPlayers(const ShardRegion* region, int shard)
+{
+	return (PlayerRoundResult*)(region->base + region->shardStride * shard + sizeof(RoundTotals));
+}
 
-	std::unique_lock<std::mutex> playerLock(currentPlayer->playerPool->playersIncrementMutex);
-	currentPlayer->playerPool->playerIncrementCondition.wait(playerLock, [&]
-		{ return currentPlayer->playerPool->gunFlag; });
+std::atomic<int64_t>* ShardRatings(const ShardRegion* region)
+{
+	return (std::atomic<int64_t>*)(region->base + region->shardStride * region->shardCount);
+}
 
-	playerLock.unlock();
+void ShardRegionRelease(ShardRegion* region)
+{
+#if defined(__linux__)
+	if (region->base)
+		munmap(region->base, region->bytes);
+#endif
+	region->base = nullptr;
+}
 
-	// Attempt to play each game, all of the game logic will occur in this function
-	Log("Player %d running\n", currentPlayer->id);
-	TryToPlayEachGame(currentPlayer);
+// Adds one share of a round's games to the round's results
+void MergeResults(RoundResults* results, const RoundTotals* totals, const PlayerRoundResult* players, int playerCount)
+{
+	results->totals.totalGamesWon += totals->totalGamesWon;
+	results->totals.totalGamesWonByX += totals->totalGamesWonByX;
+	results->totals.totalGamesTied += totals->totalGamesTied;
+	results->totals.totalPlayerWins += totals->totalPlayerWins;
+	results->totals.totalPlayerLoses += totals->totalPlayerLoses;
+	results->totals.totalPlayerTies += totals->totalPlayerTies;
+	results->totals.dtlbLoadMisses += totals->dtlbLoadMisses;
+	results->totals.tlbCountersUnavailable += totals->tlbCountersUnavailable;
+	for (int phase = 0; phase < waitPhaseCount; phase++)
+	{
+		results->totals.opponentWaits[phase] += totals->opponentWaits[phase];
+	}
+	for (int distance = 0; distance < handoffDistanceCount; distance++)
+	{
+		results->totals.handoffs[distance] += totals->handoffs[distance];
+		results->totals.handoffNanoseconds[distance] += totals->handoffNanoseconds[distance];
+	}
 
-	// Let main know there's one less player thread running. 
-	currentPlayer->playerPool->playersDecrementMutex.lock();
-	currentPlayer->playerPool->totalPlayerCount--;
-	currentPlayer->playerPool->playersDecrementMutex.unlock();
-	currentPlayer->playerPool->playerCondition.notify_all();
+	for (int i = 0; i < playerCount; i++)
+	{
+		results->players[i].gamesPlayed += players[i].gamesPlayed;
+		results->players[i].winCount += players[i].winCount;
+		results->players[i].loseCount += players[i].loseCount;
+		results->players[i].drawCount += players[i].drawCount;
+	}
 }
 
-// Displays the results of all players and all games to the console.
-void PrintResults(const Player* perPlayerData, int totalPlayerCount, const Game* perGameData, int totalGameCount)
+// Messages between the batch coordinator and its workers. Both ends are the same binary on
+//   the same machine, so the structs go over the socket as they are.
+struct BatchMessage
 {
-	int totalGamesWon = 0;
-	int totalGamesTied = 0;
-	int totalPlayerWins = 0;
-	int totalPlayerLoses = 0;
-	int totalPlayerTies = 0;
+	// Games [firstGame, firstGame + gameCount) of the round, no games means shut down
+	int64_t firstGame;
+	int64_t gameCount;
+	// Seeds the players of the batch, the same batch and seed always play out the same
+	uint64_t seed;
+	int32_t playerCount;
+};
 
-	Log("********* Player Results **********\n");
-	for (int i = 0; i < totalPlayerCount; i++)
+struct BatchResultMessage
+{
+	int64_t firstGame;
+	int64_t gameCount;
+	// Time the worker spent playing the batch
+	int64_t elapsedMicroseconds;
+	RoundTotals totals;
+	// Followed by a PlayerRoundResult for every player and a GameOutcome for every game
+};
+
+// A worker connected to the coordinator
+struct BatchWorker
+{
+	int fd;
+	// Batch the worker is playing, it's idle when gameCount is 0
+	int64_t firstGame;
+	int64_t gameCount;
+	// Batch size that keeps this worker busy for about batchTargetSeconds
+	int64_t batchGames;
+};
+
+// Hands out the games of each round in batches to whichever worker is free
+struct BatchCoordinator
+{
+	int listenFd;
+	std::vector<BatchWorker> workers;
+	// Workers the coordinator started itself
+	std::vector<int> localWorkerPids;
+	// Every batch seed is derived from this one
+	uint64_t seed;
+};
+
+// Batches are sized so a worker reports back about this often
+const double batchTargetSeconds = 0.25;
+const int64_t initialBatchGames = 256;
+const int64_t maxBatchGames = int64_t(1) << 24;
+
+bool SendAll(int fd, const void* data, size_t bytes)
+{
+#if defined(__linux__)
+	const char* next = (const char*)data;
+	while (bytes > 0)
 	{
-		Log("Player %d, Played %d game(s), Won %d, Lost %d, Draw %d\n",
-			perPlayerData[i].id,
-			perPlayerData[i].gamesPlayed,
-			perPlayerData[i].winCount,
-			perPlayerData[i].loseCount,
-			perPlayerData[i].drawCount
-		);
+		ssize_t sent = send(fd, next, bytes, MSG_NOSIGNAL);
+		if (sent <= 0)
+			return false;
+		next += sent;
+		bytes -= (size_t)sent;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
 
-		totalPlayerWins += perPlayerData[i].winCount;
-		totalPlayerLoses += perPlayerData[i].loseCount;
-		totalPlayerTies += perPlayerData[i].drawCount;
+bool ReceiveAll(int fd, void* data, size_t bytes)
+{
+#if defined(__linux__)
+	char* next = (char*)data;
+	while (bytes > 0)
+	{
+		ssize_t received = recv(fd, next, bytes, 0);
+		if (received <= 0)
+			return false;
+		next += received;
+		bytes -= (size_t)received;
 	}
+	return true;
+#else
+	return false;
+#endif
+}
 
-	Log("Total Players %d, Wins %d, Losses %d, Draws %d\n\n\n", totalPlayerCount, totalPlayerWins, totalPlayerLoses, (totalPlayerTies / 2));
+// Opens a Unix socket at 'path'. The coordinator listens on it, a worker connects to it.
+//   Returns -1 on failure.
+int OpenBatchSocket(const std::string& path, bool listening)
+{
+#if defined(__linux__)
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path))
+		return -1;
+	memcpy(address.sun_path, path.c_str(), path.size());
 
-	Log("********* Game Results **********\n");
-	for (int i = 0; i < totalGameCount; i++)
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd == -1)
+		return -1;
+
+	bool opened;
+	if (listening)
 	{
-		Log("Game %d - 'X' player %d, 'O' player %d, game result %s\n",
-			perGameData[i].gameNumber,
-			perGameData[i].playerX,
-			perGameData[i].playerO,
-			((perGameData[i].currentGameState == GameState::Won) ? "Won" : "Draw")
-		);
+		// A socket file left over from an earlier run would make bind fail
+		unlink(path.c_str());
+		opened = bind(fd, (sockaddr*)&address, sizeof(address)) == 0 && listen(fd, 64) == 0;
+	}
+	else
+	{
+		opened = connect(fd, (sockaddr*)&address, sizeof(address)) == 0;
+	}
 
-		if (perGameData[i].currentGameState == GameState::Won)
-		{
-			totalGamesWon++;
-		}
-		else
-		{
-			totalGamesTied++;
-		}
+	if (!opened)
+	{
+		close(fd);
+		return -1;
 	}
-	Log("Total Games = %d, %d Games Won, %d Games were a Draw\n\n\n", totalGameCount, totalGamesWon, totalGamesTied);
+	return fd;
+#else
+	return -1;
+#endif
 }
 
-int main(int argc, char** argv)
+// Sends 'worker' the batch [firstGame, firstGame + gameCount) of 'round'
+bool SendBatch(BatchCoordinator* coordinator, BatchWorker* worker, int round, int64_t firstGame, int64_t gameCount, int playerCount)
 {
-	// Total number of games we're going to be playing.
-	int totalGameCount;
-	// Total number of players that will be playing.
-	int totalPlayerCount;
-	// An array of player specific data with exactly one entry for each player.
-	Player* perPlayerData;
-	// Contains all data needed to keep track of players.
-	PlayerPool poolOfPlayers;
-	// An array of game specific data with exactly one entry for each game.
-	Game* perGameData;
-	// Contains all of the games. 
-	GamePool poolOfGames;
+	BatchMessage message;
+	message.firstGame = firstGame;
+	message.gameCount = gameCount;
+	message.seed = MixSeed(MixSeed(coordinator->seed, (uint64_t)round), (uint64_t)firstGame);
+	message.playerCount = playerCount;
 
-	std::cout << "Enter the number of players: ";
-	std::cin >> totalPlayerCount;
+	worker->firstGame = firstGame;
+	worker->gameCount = gameCount;
+	return SendAll(worker->fd, &message, sizeof(message));
+}
 
-	if (totalPlayerCount < 2)
+// Tells every worker to shut down and waits for the ones the coordinator started
+void StopBatchCoordinator(BatchCoordinator* coordinator, const std::string& path)
+{
+#if defined(__linux__)
+	BatchMessage shutdown;
+	memset(&shutdown, 0, sizeof(shutdown));
+	for (BatchWorker& worker : coordinator->workers)
 	{
-		std::cerr << "Error: Requires at least two players." << std::endl;
-		Pause();
-		return 1;
+		SendAll(worker.fd, &shutdown, sizeof(shutdown));
+		close(worker.fd);
 	}
+	coordinator->workers.clear();
 
-	std::cout << "Enter the number of games: ";
-	std::cin >> totalGameCount;
+	for (int pid : coordinator->localWorkerPids)
+	{
+		waitpid(pid, nullptr, 0);
+	}
+	coordinator->localWorkerPids.clear();
 
-	if (totalGameCount < 0 || totalPlayerCount < 0)
+	if (coordinator->listenFd != -1)
 	{
-		std::cerr << "Error: All arguments must be positive integer values." << std::endl;
-		Pause();
-		return 1;
+		close(coordinator->listenFd);
+		unlink(path.c_str());
 	}
+	coordinator->listenFd = -1;
+#endif
+}
 
-	if (totalGameCount < 0 || totalPlayerCount < 0)
+// Everything needed to pick a run back up where it stopped. Games are played in chunks of
+//   checkpointGames whose seeds come from the run seed, the round and the first game of the
+//   chunk, so the seed and the next-game cursor pin down every random number still to come.
+struct CheckpointHeader
+{
+	char magic[8];
+	uint32_t version;
+	int32_t playerCount;
+	int64_t totalGameCount;
+	int32_t boardSize;
+	int32_t winLength;
+	int32_t scheduleType;
+	int32_t reserved;
+	// Strategies and rating settings, a different run must not be resumed from this file
+	uint64_t settingsHash;
+	uint64_t runSeed;
+	int64_t checkpointGames;
+	// Round being played and the first game of it not played yet
+	int32_t round;
+	int32_t reserved2;
+	int64_t nextGame;
+	RoundTotals totals;
+	// Followed by a PlayerRoundResult, the rating and the round start rating of every player
+};
+
+const char checkpointMagic[8] = { 'T', 'T', 'T', 'C', 'K', 'P', 'T', '\0' };
+const uint32_t checkpointVersion = 3;
+
+// FNV-1a over the settings that change how games play out or are rated
+uint64_t CheckpointSettingsHash()
+{
+	std::string settings = simulationSettings.strategies + "|" + std::to_string(simulationSettings.eloKFactor) + "|" +
+		std::to_string(simulationSettings.mctsPlayouts) + "|" + std::to_string(simulationSettings.mctsTimeMs) + "|" +
+		std::to_string(simulationSettings.mctsThreads) + "|" + std::to_string(simulationSettings.mctsLeafParallel) + "|" +
+		std::to_string(simulationSettings.streamGames);
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (char c : settings)
 	{
-		fprintf(stderr, "Error: All arguments must be positive integer values.\n");
-		Pause();
-		return 1;
+		hash = (hash ^ (uint8_t)c) * 0x100000001B3ull;
 	}
+	return hash;
+}
 
-	if (totalPlayerCount < 2)
+// Writes the checkpoint to a temporary file, flushes it to disk and renames it over
+//   'path', so a crash at any point leaves either the old or the new checkpoint behind
+bool SaveCheckpoint(const std::string& path, const CheckpointHeader* header, const RoundResults* results, const RatingTable* ratings)
+{
+	std::string temporaryPath = path + ".tmp";
+	FILE* file = fopen(temporaryPath.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+
+	int playerCount = header->playerCount;
+	std::vector<int64_t> milliRatings(playerCount);
+	for (int i = 0; i < playerCount; i++)
 	{
-		fprintf(stderr, "Error: Requires at least two players.\n");
-		Pause();
-		return 1;
+		milliRatings[i] = ratings->milliRatings[i].load();
 	}
 
-	Log("%s starting %d player(s) for %d game(s)\n", argv[0], totalPlayerCount, totalGameCount);
+	bool written = fwrite(header, sizeof(*header), 1, file) == 1 &&
+		fwrite(results->players.data(), sizeof(PlayerRoundResult), playerCount, file) == (size_t)playerCount &&
+		fwrite(milliRatings.data(), sizeof(int64_t), playerCount, file) == (size_t)playerCount &&
+		fwrite(ratings->roundStartMilliRatings.data(), sizeof(int64_t), playerCount, file) == (size_t)playerCount &&
+		fflush(file) == 0;
+#if defined(_WIN32)
+	written = written && _commit(_fileno(file)) == 0;
+#elif defined(__linux__)
+	written = written && fsync(fileno(file)) == 0;
+#endif
+	written = (fclose(file) == 0) && written;
+	if (!written)
+		return false;
 
-	// Allocate and array of players
-	perPlayerData = new Player[totalPlayerCount];
+#if defined(_WIN32)
+	return MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	if (rename(temporaryPath.c_str(), path.c_str()) != 0)
+		return false;
+#if defined(__linux__)
+	// The rename itself only lasts once the directory is on disk too
+	size_t slash = path.find_last_of('/');
+	std::string directory = (slash == std::string::npos) ? "." : (slash == 0) ? "/" : path.substr(0, slash);
+	int directoryFd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+	if (directoryFd != -1)
+	{
+		fsync(directoryFd);
+		close(directoryFd);
+	}
+#endif
+	return true;
+#endif
+}
 
-	// Allocate array of games
-	perGameData = new Game[totalGameCount];
+// Reads the checkpoint at 'path' into 'header', 'results' and 'ratings'. Fails when the
+//   file is missing, damaged or belongs to a different run.
+bool LoadCheckpoint(const std::string& path, CheckpointHeader* header, RoundResults* results, RatingTable* ratings,
+	int playerCount, int64_t totalGameCount)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr)
+		return false;
 
-	// Initialize pool of games
-	poolOfGames.perGameData = perGameData;
-	poolOfGames.totalGameCount = totalGameCount;
+	bool loaded = fread(header, sizeof(*header), 1, file) == 1 &&
+		memcmp(header->magic, checkpointMagic, sizeof(checkpointMagic)) == 0 &&
+		header->version == checkpointVersion &&
+		header->playerCount == playerCount &&
+		header->totalGameCount == totalGameCount &&
+		header->boardSize == simulationSettings.boardSize &&
+		header->winLength == simulationSettings.winLength &&
+		header->scheduleType == (int32_t)simulationSettings.scheduleType &&
+		header->settingsHash == CheckpointSettingsHash() &&
+		header->checkpointGames > 0;
 
-	// Initialize your data in the pool of players
-	poolOfPlayers.totalPlayerCount = 0;
-	poolOfPlayers.gunFlag = false;
+	std::vector<int64_t> milliRatings(playerCount);
+	if (loaded)
+	{
+		results->players.resize(playerCount);
+		ratings->roundStartMilliRatings.resize(playerCount);
+		loaded = fread(results->players.data(), sizeof(PlayerRoundResult), playerCount, file) == (size_t)playerCount &&
+			fread(milliRatings.data(), sizeof(int64_t), playerCount, file) == (size_t)playerCount &&
+			fread(ratings->roundStartMilliRatings.data(), sizeof(int64_t), playerCount, file) == (size_t)playerCount;
+	}
+	fclose(file);
+
+	if (!loaded)
+		return false;
 
-	// Initialize each game
-	for (int i = 0; i < totalGameCount; i++)
+	results->totals = header->totals;
+	for (int i = 0; i < playerCount; i++)
 	{
-		perGameData[i].playerO = -1;
-		perGameData[i].playerX = -1;
-		perGameData[i].gameNumber = i + 1;
-		perGameData[i].currentTurn = PlayerType::X;
-		perGameData[i].currentGameState = GameState::StillPlaying;
-		perGameData[i].playerCount = 0;
-		memset(perGameData[i].gameBoard, 0, sizeof(perGameData[i].gameBoard));
+		ratings->milliRatings[i] = milliRatings[i];
 	}
+	return true;
+}
 
-	// Initialize each player
-	for (int i = 0; i < totalPlayerCount; i++)
+// Outcome of every game of a run, written straight into a memory mapped file instead of
+//   being printed. The record of game g of round r sits at r * gamesPerRound + g, so
+//   whoever plays a game writes its own record and nobody has to coordinate. Records that
+//   were never written are all zero, which no real game can produce.
+struct ResultsFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	int32_t playerCount;
+	int64_t gamesPerRound;
+	int32_t boardSize;
+	int32_t winLength;
+	int32_t scheduleType;
+	int32_t reserved;
+	uint64_t runSeed;
+	// Rounds whose records are complete
+	int64_t roundCount;
+	// Followed by gamesPerRound GameOutcome records for every round
+};
+
+const char resultsMagic[8] = { 'T', 'T', 'T', 'R', 'S', 'L', 'T', '\0' };
+const uint32_t resultsVersion = 2;
+
+// An open results file. The mapping is grown a round at a time, which moves it, so
+//   pointers into it only hold until the next ResultsFileReserve.
+struct ResultsFile
+{
+	ResultsFileHeader* header;
+	size_t bytes;
+	// Rounds the mapping has room for
+	int64_t roundCapacity;
+#if defined(_WIN32)
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int fd;
+#endif
+};
+
+GameOutcome* ResultsRecords(const ResultsFile* results, int64_t round)
+{
+	return (GameOutcome*)(results->header + 1) + round * results->header->gamesPerRound;
+}
+
+// Maps the first 'bytes' of the open file, growing the file to that size first
+bool ResultsFileMap(ResultsFile* results, size_t bytes, bool writable)
+{
+#if defined(_WIN32)
+	ULARGE_INTEGER size;
+	size.QuadPart = bytes;
+	results->mapping = CreateFileMappingA(results->file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, size.HighPart, size.LowPart, nullptr);
+	if (results->mapping == nullptr)
+		return false;
+
+	void* view = MapViewOfFile(results->mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, bytes);
+	if (view == nullptr)
 	{
-		perPlayerData[i].id = i;
-		perPlayerData[i].drawCount = 0;
-		perPlayerData[i].gamesPlayed = 0;
-		perPlayerData[i].loseCount = 0;
-		perPlayerData[i].winCount = 0;
-		perPlayerData[i].gamePool = &poolOfGames;
-		perPlayerData[i].playerPool = &poolOfPlayers;
-		perPlayerData[i].type = PlayerType::None;
-		perPlayerData[i].myRand.Init(0, INT_MAX);
+		CloseHandle(results->mapping);
+		results->mapping = nullptr;
+		return false;
 	}
+#elif defined(__linux__)
+	if (writable && ftruncate(results->fd, (off_t)bytes) != 0)
+		return false;
 
-	bool playAgain = true;
+	void* view = mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, results->fd, 0);
+	if (view == MAP_FAILED)
+		return false;
+#else
+	return false;
+#endif
+	results->header = (ResultsFileHeader*)view;
+	results->bytes = bytes;
+	return true;
+}
 
-	while (playAgain) {
-		// Start the player threads
-		for (int i = 0; i < totalPlayerCount; i++) {
-			std::thread(PlayerThreadEntrypoint, &perPlayerData[i]).detach();
-		}
+void ResultsFileUnmap(ResultsFile* results)
+{
+	if (results->header == nullptr)
+		return;
+#if defined(_WIN32)
+	UnmapViewOfFile(results->header);
+	CloseHandle(results->mapping);
+	results->mapping = nullptr;
+#elif defined(__linux__)
+	munmap(results->header, results->bytes);
+#endif
+	results->header = nullptr;
+}
 
-		// Wait for all players to be ready 
-		std::unique_lock<std::mutex> totalPlayerCountUniqueLock(poolOfPlayers.totalPlayersMutex);
-		poolOfPlayers.playerCondition.wait(totalPlayerCountUniqueLock, [&] {return poolOfPlayers.totalPlayerCount == totalPlayerCount; });
+// Makes room for the records of rounds [0, roundCount). Records already written stay put.
+bool ResultsFileReserve(ResultsFile* results, int64_t roundCount)
+{
+	if (roundCount <= results->roundCapacity)
+		return true;
 
-		poolOfPlayers.startingGunMutex.lock();
-		poolOfPlayers.gunFlag = true;
-		poolOfPlayers.startingGunMutex.unlock();
+	size_t bytes = sizeof(ResultsFileHeader) + sizeof(GameOutcome) * (size_t)(results->header->gamesPerRound * roundCount);
+	ResultsFileUnmap(results);
+	if (!ResultsFileMap(results, bytes, true))
+		return false;
 
-		// Notify all waiting threads that they can start playing.
-		poolOfPlayers.playerIncrementCondition.notify_all();
-		poolOfPlayers.playerDecrementCondition.notify_all();
+	results->roundCapacity = roundCount;
+	return true;
+}
 
-		// Wait for all detached player threads to complete.
-		poolOfPlayers.playerCondition.wait(totalPlayerCountUniqueLock, [&] {return poolOfPlayers.totalPlayerCount == 0; });
+// Opens the results file at 'path' for a run of 'roundCount' rounds of 'gamesPerRound'
+//   games. A resumed run keeps the records of the run it continues and fails when the file
+//   belongs to a different run, anything else starts the file over.
+bool ResultsFileCreate(ResultsFile* results, const std::string& path, int playerCount, int64_t gamesPerRound, int64_t roundCount, bool resume)
+{
+	results->header = nullptr;
+	results->roundCapacity = 0;
+#if defined(_WIN32)
+	results->mapping = nullptr;
+	results->file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+		resume ? OPEN_EXISTING : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (results->file == INVALID_HANDLE_VALUE)
+		return false;
+#elif defined(__linux__)
+	results->fd = open(path.c_str(), resume ? O_RDWR : O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (results->fd == -1)
+		return false;
+#else
+	results->fd = -1;
+	return false;
+#endif
 
-		PrintResults(perPlayerData, totalPlayerCount, perGameData, totalGameCount);
+	ResultsFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, resultsMagic, sizeof(resultsMagic));
+	header.version = resultsVersion;
+	header.playerCount = playerCount;
+	header.gamesPerRound = gamesPerRound;
+	header.boardSize = simulationSettings.boardSize;
+	header.winLength = simulationSettings.winLength;
+	header.scheduleType = (int32_t)simulationSettings.scheduleType;
+	header.runSeed = simulationSettings.runSeed;
 
-		// Ask the user if they want to play again
-		char playAgainResponse;
-		std::cout << "Do you want to play again? (y/n): ";
-		std::cin >> playAgainResponse;
+	if (!ResultsFileMap(results, sizeof(ResultsFileHeader) + sizeof(GameOutcome) * (size_t)(gamesPerRound * roundCount), true))
+		return false;
+	results->roundCapacity = roundCount;
 
-		playAgain = (playAgainResponse == 'y' || playAgainResponse == 'Y');
+	if (resume)
+	{
+		// Everything but the completed rounds has to match
+		header.roundCount = results->header->roundCount;
+		return memcmp(&header, results->header, sizeof(header)) == 0;
+	}
 
-		// Cleanup
-		LogSync(LogSyncOperation::Release);
+	*results->header = header;
+	return true;
+}
 
-		// Reset game state for the next round
-		for (int i = 0; i < totalGameCount; i++) {
-			perGameData[i].playerO = -1;
-			perGameData[i].playerX = -1;
-			perGameData[i].currentTurn = PlayerType::X;
-			perGameData[i].currentGameState = GameState::StillPlaying;
-			perGameData[i].playerCount = 0;
-			memset(perGameData[i].gameBoard, 0, sizeof(perGameData[i].gameBoard));
-		}
+// Pushes the records written so far to disk, so a checkpoint never claims games whose
+//   records could still be lost
+bool ResultsFileSync(const ResultsFile* results)
+{
+#if defined(_WIN32)
+	return FlushViewOfFile(results->header, results->bytes) != 0 && FlushFileBuffers(results->file) != 0;
+#elif defined(__linux__)
+	return msync(results->header, results->bytes, MS_SYNC) == 0;
+#else
+	return false;
+#endif
+}
 
-		for (int i = 0; i < totalPlayerCount; i++) {
-			perPlayerData[i].gamesPlayed = 0;
-			perPlayerData[i].winCount = 0;
-			perPlayerData[i].loseCount = 0;
-			perPlayerData[i].drawCount = 0;
-			perPlayerData[i].type = PlayerType::None;
-		}
+void ResultsFileClose(ResultsFile* results)
+{
+	ResultsFileUnmap(results);
+#if defined(_WIN32)
+	if (results->file != INVALID_HANDLE_VALUE)
+		CloseHandle(results->file);
+#elif defined(__linux__)
+	if (results->fd != -1)
+		close(results->fd);
+#endif
+}
+
+// Maps the results file at 'path' read only for a report on it. Prints what went wrong and
+//   returns false when it can't be mapped or isn't a results file.
+bool ResultsFileOpen(ResultsFile* results, const std::string& path)
+{
+	results->header = nullptr;
+	size_t fileBytes = 0;
+#if defined(_WIN32)
+	results->mapping = nullptr;
+	results->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER size;
+	if (results->file != INVALID_HANDLE_VALUE && GetFileSizeEx(results->file, &size))
+		fileBytes = (size_t)size.QuadPart;
+#elif defined(__linux__)
+	results->fd = open(path.c_str(), O_RDONLY);
+	struct stat status;
+	if (results->fd != -1 && fstat(results->fd, &status) == 0)
+		fileBytes = (size_t)status.st_size;
+#else
+	results->fd = -1;
+#endif
+
+	if (fileBytes < sizeof(ResultsFileHeader) || !ResultsFileMap(results, fileBytes, false))
+	{
+		std::cerr << "Error: Could not map the results file '" << path << "'." << std::endl;
+		ResultsFileClose(results);
+		return false;
+	}
+
+	const ResultsFileHeader* header = results->header;
+	if (memcmp(header->magic, resultsMagic, sizeof(resultsMagic)) != 0 || header->version != resultsVersion ||
+		header->playerCount < 2 || header->gamesPerRound < 0 ||
+		sizeof(ResultsFileHeader) + sizeof(GameOutcome) * (size_t)(header->gamesPerRound * header->roundCount) > fileBytes)
+	{
+		std::cerr << "Error: '" << path << "' is not a results file or is damaged." << std::endl;
+		ResultsFileClose(results);
+		return false;
 	}
+	return true;
+}
 
-	// Cleanup and exit
-	delete[] perGameData;
-	delete[] perPlayerData;
+// Totals of one player over every record of a results file
+struct PlayerAnalysis
+{
+	int64_t gamesAsX;
+	int64_t gamesAsO;
+	int64_t winsAsX;
+	int64_t winsAsO;
+	int64_t draws;
+};
 
-	Pause();
-	return 0;
-}
\ No newline at end of file
+bool ReplayClassicGame(uint32_t moveCode, PlayerType* winner, int* moveCount);
+
+// Maps the results file at 'path' read only and reports on its records without going
+//   through any text. Games on the classic board are replayed from their move codes.
+//   Returns the process exit code.
+int AnalyzeResultsFile(const std::string& path)
+{
+	ResultsFile results;
+	if (!ResultsFileOpen(&results, path))
+		return 1;
+
+	const ResultsFileHeader* header = results.header;
+	int playerCount = header->playerCount;
+	Log("%s: %d player(s), %lld game(s) per round, %lld round(s) on a %dx%d board, %d in a row wins, seed %llu\n",
+		path.c_str(), playerCount, (long long)header->gamesPerRound, (long long)header->roundCount,
+		header->boardSize, header->boardSize, header->winLength, (unsigned long long)header->runSeed);
+
+	std::vector<PlayerAnalysis> players(playerCount, PlayerAnalysis());
+	int64_t allWinsByX = 0;
+	int64_t allWinsByO = 0;
+	int64_t allDraws = 0;
+	int64_t badRecords = 0;
+	int64_t unplayedRecords = 0;
+	// Number of games by how many moves they took, classic board only
+	bool hasMoveCodes = header->boardSize == 3 && header->winLength == 3;
+	int64_t gameLengths[10] = {};
+
+	Log("********* Rounds **********\n");
+	for (int64_t round = 0; round < header->roundCount; round++)
+	{
+		const GameOutcome* records = ResultsRecords(&results, round);
+		int64_t winsByX = 0;
+		int64_t winsByO = 0;
+		int64_t draws = 0;
+		for (int64_t i = 0; i < header->gamesPerRound; i++)
+		{
+			const GameOutcome& outcome = records[i];
+			if (!OutcomeWasPlayed(outcome))
+			{
+				unplayedRecords++;
+				continue;
+			}
+			if (!OutcomeIsValid(outcome, playerCount))
+			{
+				badRecords++;
+				continue;
+			}
+
+			if (hasMoveCodes)
+			{
+				// The moves have to lead to the outcome on record
+				PlayerType winner;
+				int moveCount;
+				if (!ReplayClassicGame(OutcomeMoveCode(outcome), &winner, &moveCount) || winner != (PlayerType)outcome.winner)
+				{
+					badRecords++;
+					continue;
+				}
+				gameLengths[moveCount]++;
+			}
+
+			PlayerAnalysis& x = players[outcome.playerX];
+			PlayerAnalysis& o = players[outcome.playerO];
+			x.gamesAsX++;
+			o.gamesAsO++;
+			if (outcome.winner == (uint8_t)PlayerType::X)
+			{
+				winsByX++;
+				x.winsAsX++;
+			}
+			else if (outcome.winner == (uint8_t)PlayerType::O)
+			{
+				winsByO++;
+				o.winsAsO++;
+			}
+			else
+			{
+				draws++;
+				x.draws++;
+				o.draws++;
+			}
+		}
+
+		Log("Round %lld - %lld won by 'X', %lld won by 'O', %lld draw(s)\n",
+			(long long)(round + 1), (long long)winsByX, (long long)winsByO, (long long)draws);
+		allWinsByX += winsByX;
+		allWinsByO += winsByO;
+		allDraws += draws;
+	}
+
+	int64_t allGames = allWinsByX + allWinsByO + allDraws;
+	if (hasMoveCodes)
+	{
+		Log("********* Game Lengths **********\n");
+		for (int moveCount = 5; moveCount <= 9; moveCount++)
+		{
+			Log("%d moves - %lld game(s)\n", moveCount, (long long)gameLengths[moveCount]);
+		}
+	}
+
+	Log("********* Players **********\n");
+	for (int i = 0; i < playerCount; i++)
+	{
+		const PlayerAnalysis& player = players[i];
+		int64_t games = player.gamesAsX + player.gamesAsO;
+		int64_t wins = player.winsAsX + player.winsAsO;
+		int64_t losses = games - wins - player.draws;
+		Log("Player %d - %lld game(s), %lld won, %lld lost, %lld draw(s), won %.1f%% as 'X' and %.1f%% as 'O'\n",
+			i, (long long)games, (long long)wins, (long long)losses, (long long)player.draws,
+			(player.gamesAsX > 0) ? 100.0 * player.winsAsX / player.gamesAsX : 0.0,
+			(player.gamesAsO > 0) ? 100.0 * player.winsAsO / player.gamesAsO : 0.0);
+	}
+
+	Log("Total Games = %lld, 'X' won %.2f%%, 'O' won %.2f%%, %.2f%% were a Draw\n", (long long)allGames,
+		(allGames > 0) ? 100.0 * allWinsByX / allGames : 0.0,
+		(allGames > 0) ? 100.0 * allWinsByO / allGames : 0.0,
+		(allGames > 0) ? 100.0 * allDraws / allGames : 0.0);
+	if (unplayedRecords > 0)
+	{
+		Log("%lld game(s) were not played, the run was stopped early\n", (long long)unplayedRecords);
+	}
+	if (badRecords > 0)
+	{
+		Log("%lld record(s) are damaged\n", (long long)badRecords);
+	}
+
+	ResultsFileClose(&results);
+	return (badRecords > 0) ? 1 : 0;
+}
+
+// Prints the current game board to the console
+template <class Rules>
+void PrintGameBoard(const Game<Rules>* currentGame)
+{
+	if (simulationSettings.quiet)
+		return;
+
+	// Prints the game board to the screen as a single block of text
+	LogSync(LogSyncOperation::Lock);
+
+	for (int row = 0; row < Rules::size; row++)
+	{
+		for (int col = 0; col < Rules::size; col++)
+		{
+			if (currentGame->gameBoard[row][col] == PlayerType::None)
+			{
+				printf("[ ]");
+			}
+			else
+			{
+				printf("[%c]", (currentGame->gameBoard[row][col] == PlayerType::X) ? 'X' : 'O');
+			}
+			std::this_thread::yield();
+		}
+		printf("\n");
+	}
+	LogSync(LogSyncOperation::Unlock);
+}
+
+// Determines if taking (row, col) completed a line for 'type'. 'cells' is the bitboard
+//   of 'type' with the new cell already set. Shared by the game and the search playouts.
+template <class Rules>
+bool IsWinningMove(const PlayerType (&gameBoard)[Rules::size][Rules::size], const typename Rules::Mask& cells, int row, int col, PlayerType type)
+{
+	if constexpr (Rules::hasBitboard)
+	{
+		// Only lines through the cell that was just taken can have been completed
+		using Mask = typename Rules::Mask;
+		const int cell = row * Rules::size + col;
+		const auto& winLines = WinLines<Rules>::table;
+
+		for (int i = 0; i < winLines.lineCount[cell]; i++)
+		{
+			if ((Mask)(cells & winLines.lines[cell][i]) == winLines.lines[cell][i])
+				return true;
+		}
+		return false;
+	}
+	else
+	{
+		// Count this player's cells outwards from the move in both directions along
+		//  the row, the column and both diagonals.
+		const int directions[4][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 1, -1 } };
+
+		for (int d = 0; d < 4; d++)
+		{
+			int inARow = 1;
+			for (int sign = -1; sign <= 1; sign += 2)
+			{
+				int r = row + sign * directions[d][0];
+				int c = col + sign * directions[d][1];
+				while (r >= 0 && r < Rules::size && c >= 0 && c < Rules::size && gameBoard[r][c] == type)
+				{
+					inARow++;
+					r += sign * directions[d][0];
+					c += sign * directions[d][1];
+				}
+			}
+
+			if (inARow >= Rules::winLength)
+				return true;
+		}
+		return false;
+	}
+}
+
+// Determines if the player made a winning move on the game board
+template <class Rules>
+bool DidWeWin(int row, int col, const Game<Rules>* game, const Player<Rules>* player)
+{
+	return IsWinningMove<Rules>(game->gameBoard, (player->type == PlayerType::X) ? game->xCells : game->oCells, row, col, player->type);
+}
+
+// Number of orders the 9 cells of the classic board can be taken in, every move code of a
+//   classic game is below it
+const uint32_t classicMoveCodeCount = 362880;
+
+// Replays the game 'moveCode' describes, see EncodeMoveSequence, through the same move and
+//   win logic the game threads use until a line is complete or the board is full. Stores
+//   the winner and the number of moves, returns false for codes past the last permutation
+//   which are no game at all.
+bool ReplayClassicGame(uint32_t moveCode, PlayerType* winner, int* moveCount)
+{
+	if (moveCode >= classicMoveCodeCount)
+		return false;
+
+	uint8_t cells[9];
+	DecodeMoveSequence(moveCode, 9, cells);
+
+	PlayerType gameBoard[ClassicRules::size][ClassicRules::size] = {};
+	ClassicRules::Mask sides[2] = { 0, 0 };
+	*winner = PlayerType::None;
+	for (int move = 0; move < ClassicRules::cellCount; move++)
+	{
+		// 'X' makes the even moves
+		PlayerType type = (move % 2 == 0) ? PlayerType::X : PlayerType::O;
+		int row = cells[move] / ClassicRules::size;
+		int col = cells[move] % ClassicRules::size;
+		gameBoard[row][col] = type;
+		sides[move % 2] |= ClassicRules::CellBit(cells[move]);
+		*moveCount = move + 1;
+		if (IsWinningMove<ClassicRules>(gameBoard, sides[move % 2], row, col, type))
+		{
+			*winner = type;
+			break;
+		}
+	}
+	return true;
+}
+
+// Replays records [first, last) with ReplayClassicGame and counts the ones that don't end
+//   the way they were recorded in 'mismatches'. The lowest index of those goes to
+//   'firstMismatch', records that are not valid for 'playerCount' players count as
+//   mismatches too. Games that were never played are skipped and counted in 'unplayed'.
+void ReplayRecords(const GameOutcome* records, int64_t first, int64_t last, int playerCount, int64_t* mismatches, int64_t* firstMismatch,
+	int64_t* unplayed)
+{
+	for (int64_t i = first; i < last; i++)
+	{
+		const GameOutcome& outcome = records[i];
+		if (!OutcomeWasPlayed(outcome))
+		{
+			(*unplayed)++;
+			continue;
+		}
+
+		PlayerType winner;
+		int moveCount;
+		bool matches = OutcomeIsValid(outcome, playerCount) && ReplayClassicGame(OutcomeMoveCode(outcome), &winner, &moveCount) &&
+			winner == (PlayerType)outcome.winner;
+
+		if (!matches)
+		{
+			if (*mismatches == 0)
+				*firstMismatch = i;
+			(*mismatches)++;
+		}
+	}
+}
+
+// Replays every game in the results file at 'path' from its move code, split between
+//   replayThreads threads, and checks that each one ends the way it was recorded. Reports
+//   the replay speed, which makes it a quick check of the engine after changing it.
+//   Returns the process exit code.
+int ReplayResultsFile(const std::string& path)
+{
+	ResultsFile results;
+	if (!ResultsFileOpen(&results, path))
+		return 1;
+
+	const ResultsFileHeader* header = results.header;
+	if (header->boardSize != ClassicRules::size || header->winLength != ClassicRules::winLength)
+	{
+		std::cerr << "Error: Only games on the classic board are stored with their moves." << std::endl;
+		ResultsFileClose(&results);
+		return 1;
+	}
+
+	int threadCount = simulationSettings.replayThreads;
+	if (threadCount <= 0)
+		threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+
+	const GameOutcome* records = ResultsRecords(&results, 0);
+	int64_t recordCount = header->gamesPerRound * header->roundCount;
+	std::vector<int64_t> mismatches(threadCount, 0);
+	std::vector<int64_t> firstMismatch(threadCount, 0);
+	std::vector<int64_t> unplayed(threadCount, 0);
+	std::vector<std::thread> threads;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < threadCount; i++)
+	{
+		threads.emplace_back(ReplayRecords, records, recordCount * i / threadCount, recordCount * (i + 1) / threadCount,
+			header->playerCount, &mismatches[i], &firstMismatch[i], &unplayed[i]);
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	int64_t mismatchCount = 0;
+	int64_t unplayedCount = 0;
+	int64_t firstIndex = recordCount;
+	for (int i = 0; i < threadCount; i++)
+	{
+		mismatchCount += mismatches[i];
+		unplayedCount += unplayed[i];
+		if (mismatches[i] > 0)
+			firstIndex = std::min(firstIndex, firstMismatch[i]);
+	}
+
+	int64_t replayedCount = recordCount - unplayedCount;
+	Log("Replayed %lld game(s) on %d thread(s) in %.3f s, %.1f million games/s\n", (long long)replayedCount, threadCount, seconds,
+		(seconds > 0.0) ? replayedCount / seconds / 1e6 : 0.0);
+
+	if (unplayedCount > 0)
+	{
+		Log("%lld game(s) were not played, the run was stopped early\n", (long long)unplayedCount);
+	}
+	if (mismatchCount == 0)
+	{
+		Log("Every game ended the way it was recorded\n");
+	}
+	else
+	{
+		Log("%lld game(s) did not end the way they were recorded, the first is game %lld of round %lld\n", (long long)mismatchCount,
+			(long long)(firstIndex % header->gamesPerRound + 1), (long long)(firstIndex / header->gamesPerRound + 1));
+	}
+
+	ResultsFileClose(&results);
+	return (mismatchCount > 0) ? 1 : 0;
+}
+
+// Every line of three on the board as a mask of cells
+const uint16_t winMasks[8] =
+{
+	0x007, 0x038, 0x1C0, // Rows
+	0x049, 0x092, 0x124, // Columns
+	0x111, 0x054        // Diagonals
+};
+
+// Mask with every cell on the board set
+const uint16_t fullBoardMask = 0x1FF;
+
+// Returns the number of set bits in 'mask'
+int CountBits(uint32_t mask)
+{
+	int count = 0;
+	while (mask)
+	{
+		mask &= mask - 1;
+		count++;
+	}
+	return count;
+}
+
+// Returns true if 'cells' contains a complete line
+bool HasLine(uint16_t cells)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		if ((cells & winMasks[i]) == winMasks[i])
+			return true;
+	}
+	return false;
+}
+
+// Builds the transposition table key for a position. Every position can be indexed
+//   directly since a cell can only belong to one player.
+int BoardKey(uint16_t xCells, uint16_t oCells)
+{
+	return (xCells << 9) | oCells;
+}
+
+// The 8 symmetries of the board, the rotations and reflections. A position and its 7
+//   images play out the same way, so the tables below only store one of them: the canonical
+//   form, which is whichever image has the smallest BoardKey.
+class BoardSymmetries
+{
+public:
+	// Number of distinct positions when every cell is empty, 'X' or 'O'
+	static const int ternaryKeyCount = 19683;
+
+	BoardSymmetries()
+	{
+		for (int symmetry = 0; symmetry < 8; symmetry++)
+		{
+			for (int cell = 0; cell < 9; cell++)
+			{
+				// Transpose first for the reflections, then rotate a quarter turn at a time
+				int row = cell / 3;
+				int col = cell % 3;
+				if (symmetry >= 4)
+					std::swap(row, col);
+				for (int turn = 0; turn < symmetry % 4; turn++)
+				{
+					int rotatedRow = col;
+					col = 2 - row;
+					row = rotatedRow;
+				}
+				cellMap[symmetry][cell] = (int8_t)(row * 3 + col);
+			}
+		}
+
+		for (int symmetry = 0; symmetry < 8; symmetry++)
+		{
+			for (int other = 0; other < 8; other++)
+			{
+				bool undoes = true;
+				for (int cell = 0; cell < 9; cell++)
+				{
+					if (cellMap[other][cellMap[symmetry][cell]] != cell)
+						undoes = false;
+				}
+				if (undoes)
+					inverse[symmetry] = (int8_t)other;
+			}
+		}
+
+		for (int mask = 0; mask < 512; mask++)
+		{
+			ternary[mask] = 0;
+			int digit = 1;
+			for (int cell = 0; cell < 9; cell++, digit *= 3)
+			{
+				if (mask & (1 << cell))
+					ternary[mask] += (uint16_t)digit;
+			}
+
+			for (int symmetry = 0; symmetry < 8; symmetry++)
+			{
+				maskMap[symmetry][mask] = MapMaskSlow(symmetry, (uint16_t)mask);
+			}
+		}
+	}
+
+	// Returns the symmetry that takes the position to its canonical form and stores the
+	//   canonical form in 'canonicalX' and 'canonicalO'
+	int Canonicalize(uint16_t xCells, uint16_t oCells, uint16_t* canonicalX, uint16_t* canonicalO) const
+	{
+		// The symmetry rides along in the low bits, so picking the smallest key is a plain
+		//   min the compiler can do without branches
+		int best = BoardKey(xCells, oCells) << 3;
+		for (int symmetry = 1; symmetry < 8; symmetry++)
+		{
+			best = std::min(best, (BoardKey(maskMap[symmetry][xCells], maskMap[symmetry][oCells]) << 3) | symmetry);
+		}
+		*canonicalX = (uint16_t)(best >> 12);
+		*canonicalO = (uint16_t)((best >> 3) & 0x1FF);
+		return best & 7;
+	}
+
+	// Dense index of a position in [0, ternaryKeyCount), reading every cell as a base 3 digit
+	int TernaryKey(uint16_t xCells, uint16_t oCells) const
+	{
+		return ternary[xCells] + 2 * ternary[oCells];
+	}
+
+	// Where 'cell' ends up under 'symmetry'
+	int MapCell(int symmetry, int cell) const
+	{
+		return cellMap[symmetry][cell];
+	}
+
+	// Where 'cell' came from under 'symmetry', undoes MapCell
+	int UnmapCell(int symmetry, int cell) const
+	{
+		return cellMap[inverse[symmetry]][cell];
+	}
+
+	uint16_t MapMask(int symmetry, uint16_t mask) const
+	{
+		return maskMap[symmetry][mask];
+	}
+
+	uint16_t UnmapMask(int symmetry, uint16_t mask) const
+	{
+		return maskMap[inverse[symmetry]][mask];
+	}
+
+private:
+	uint16_t MapMaskSlow(int symmetry, uint16_t mask) const
+	{
+		uint16_t mapped = 0;
+		for (int cell = 0; cell < 9; cell++)
+		{
+			if (mask & (1 << cell))
+				mapped |= (uint16_t)(1 << cellMap[symmetry][cell]);
+		}
+		return mapped;
+	}
+
+	int8_t cellMap[8][9];
+	int8_t inverse[8];
+	// Every 9 cell mask under every symmetry, so a whole side is moved with one lookup
+	uint16_t maskMap[8][512];
+	uint16_t ternary[512];
+};
+
+const BoardSymmetries boardSymmetries;
+
+// Negamax solver with alpha-beta pruning and a transposition table keyed on the canonical
+//   form of the bitboard. Solve() walks every reachable position once at startup and records
+//   the best move for each, so picking a perfect move at runtime is a single lookup.
+class MinimaxSolver
+{
+public:
+	// Solves the whole game tree. Safe to call more than once, only the first call does any work.
+	void Solve()
+	{
+		if (solved)
+			return;
+
+		table.assign(BoardSymmetries::ternaryKeyCount, Entry());
+		perfectMoves.assign(BoardSymmetries::ternaryKeyCount, -1);
+		SolveReachable(0, 0);
+		solved = true;
+	}
+
+	// Returns the cell the side to move should take, or -1 if the game is already over.
+	int PerfectMove(uint16_t xCells, uint16_t oCells) const
+	{
+		uint16_t canonicalX;
+		uint16_t canonicalO;
+		int symmetry = boardSymmetries.Canonicalize(xCells, oCells, &canonicalX, &canonicalO);
+		int move = perfectMoves[boardSymmetries.TernaryKey(canonicalX, canonicalO)];
+		return (move == -1) ? -1 : boardSymmetries.UnmapCell(symmetry, move);
+	}
+
+private:
+	enum class Bound : uint8_t
+	{
+		None,
+		Exact,
+		Lower,
+		Upper
+	};
+
+	struct Entry
+	{
+		int8_t value = 0;
+		Bound bound = Bound::None;
+	};
+
+	static const int scoreLimit = 100;
+
+	// Searches the position where 'mine' belongs to the side to move.
+	int Negamax(uint16_t mine, uint16_t theirs, bool mineIsX, int alpha, int beta, int* bestMove)
+	{
+		// The opponent made the last move, so only they can have completed a line.
+		uint16_t occupied = mine | theirs;
+		int emptyCount = 9 - CountBits(occupied);
+		if (HasLine(theirs))
+			return -(emptyCount + 1);
+		if (emptyCount == 0)
+			return 0;
+
+		Entry& entry = table[CanonicalKey(mineIsX ? mine : theirs, mineIsX ? theirs : mine)];
+		int originalAlpha = alpha;
+		if (bestMove == nullptr && entry.bound != Bound::None)
+		{
+			if (entry.bound == Bound::Exact)
+				return entry.value;
+			if (entry.bound == Bound::Lower && entry.value >= beta)
+				return entry.value;
+			if (entry.bound == Bound::Upper && entry.value <= alpha)
+				return entry.value;
+		}
+
+		int bestValue = -scoreLimit;
+		for (int cell = 0; cell < 9; cell++)
+		{
+			uint16_t cellBit = (uint16_t)(1 << moveOrder[cell]);
+			if (occupied & cellBit)
+				continue;
+
+			int value = -Negamax(theirs, mine | cellBit, !mineIsX, -beta, -alpha, nullptr);
+			if (value > bestValue)
+			{
+				bestValue = value;
+				if (bestMove)
+					*bestMove = moveOrder[cell];
+			}
+			if (value > alpha)
+				alpha = value;
+			if (alpha >= beta)
+				break;
+		}
+
+		entry.value = (int8_t)bestValue;
+		if (bestValue <= originalAlpha)
+			entry.bound = Bound::Upper;
+		else if (bestValue >= beta)
+			entry.bound = Bound::Lower;
+		else
+			entry.bound = Bound::Exact;
+
+		return bestValue;
+	}
+
+	static int CanonicalKey(uint16_t xCells, uint16_t oCells)
+	{
+		uint16_t canonicalX;
+		uint16_t canonicalO;
+		boardSymmetries.Canonicalize(xCells, oCells, &canonicalX, &canonicalO);
+		return boardSymmetries.TernaryKey(canonicalX, canonicalO);
+	}
+
+	// Records the perfect move for this position and every position reachable from it. The
+	//   move is stored for the canonical form, so symmetric positions are only solved once.
+	void SolveReachable(uint16_t xCells, uint16_t oCells)
+	{
+		uint16_t canonicalX;
+		uint16_t canonicalO;
+		int symmetry = boardSymmetries.Canonicalize(xCells, oCells, &canonicalX, &canonicalO);
+		int key = boardSymmetries.TernaryKey(canonicalX, canonicalO);
+		uint16_t occupied = xCells | oCells;
+		if (perfectMoves[key] != -1 || HasLine(xCells) || HasLine(oCells) || occupied == fullBoardMask)
+			return;
+
+		// A full window search at the root gives an exact value, so the move is truly optimal.
+		bool xToMove = CountBits(xCells) == CountBits(oCells);
+		int bestMove = -1;
+		if (xToMove)
+			Negamax(xCells, oCells, true, -scoreLimit, scoreLimit, &bestMove);
+		else
+			Negamax(oCells, xCells, false, -scoreLimit, scoreLimit, &bestMove);
+		perfectMoves[key] = (int8_t)boardSymmetries.MapCell(symmetry, bestMove);
+
+		for (int cell = 0; cell < 9; cell++)
+		{
+			uint16_t cellBit = (uint16_t)(1 << cell);
+			if (occupied & cellBit)
+				continue;
+
+			if (xToMove)
+				SolveReachable(xCells | cellBit, oCells);
+			else
+				SolveReachable(xCells, oCells | cellBit);
+		}
+	}
+
+	// Center first, then corners, then edges. Good moves first means more cutoffs.
+	const int moveOrder[9] = { 4, 0, 2, 6, 8, 1, 3, 5, 7 };
+
+	bool solved = false;
+	// Both indexed by the TernaryKey of the canonical form
+	std::vector<Entry> table;
+	std::vector<int8_t> perfectMoves;
+};
+
+MinimaxSolver minimaxSolver;
+
+// Everything we know about a single reachable position
+struct PositionInfo
+{
+	// Winner when both sides play perfectly from here, PlayerType::None for a draw
+	PlayerType perfectWinner;
+	// Every cell the side to move can take without giving up the perfect play outcome
+	uint16_t optimalMoves;
+	// Exact outcome probabilities when both sides pick uniformly random empty cells
+	double xWinChance;
+	double oWinChance;
+	double drawChance;
+};
+
+// Table of every position reachable from the empty board, built once at startup. Only the
+//   canonical form of each position is stored: Tic-Tac-Toe has 5,478 reachable positions
+//   but just 765 up to symmetry, so the whole tree fits comfortably in L1.
+class GameTreeTable
+{
+public:
+	// Number of legal positions up to symmetry, counting the empty board and finished games
+	static const int canonicalPositionCount = 765;
+
+	void Build()
+	{
+		if (!positions.empty())
+			return;
+
+		positionIndex.assign(BoardSymmetries::ternaryKeyCount, -1);
+		positions.reserve(canonicalPositionCount);
+		BuildPosition(0, 0);
+
+		if ((int)positions.size() != canonicalPositionCount)
+		{
+			Log("ERROR: Game tree has %d positions, expected %d.\n", (int)positions.size(), canonicalPositionCount);
+		}
+	}
+
+	// Returns the info for a position reachable in a real game, with the optimal moves
+	//   turned back to the orientation of the position asked for
+	PositionInfo Lookup(uint16_t xCells, uint16_t oCells) const
+	{
+		uint16_t canonicalX;
+		uint16_t canonicalO;
+		int symmetry = boardSymmetries.Canonicalize(xCells, oCells, &canonicalX, &canonicalO);
+		PositionInfo info = positions[positionIndex[boardSymmetries.TernaryKey(canonicalX, canonicalO)]];
+		info.optimalMoves = boardSymmetries.UnmapMask(symmetry, info.optimalMoves);
+		return info;
+	}
+
+	int PositionCount() const
+	{
+		return (int)positions.size();
+	}
+
+private:
+	// Ranks an outcome from the point of view of 'mover', higher is better
+	static int OutcomeRank(PlayerType winner, PlayerType mover)
+	{
+		if (winner == PlayerType::None)
+			return 1;
+		return (winner == mover) ? 2 : 0;
+	}
+
+	// Fills in this position and everything below it, returns its index in 'positions'
+	int BuildPosition(uint16_t xCells, uint16_t oCells)
+	{
+		uint16_t canonicalX;
+		uint16_t canonicalO;
+		int symmetry = boardSymmetries.Canonicalize(xCells, oCells, &canonicalX, &canonicalO);
+		int key = boardSymmetries.TernaryKey(canonicalX, canonicalO);
+		if (positionIndex[key] != -1)
+			return positionIndex[key];
+
+		PositionInfo info = {};
+		uint16_t occupied = xCells | oCells;
+		if (HasLine(xCells))
+		{
+			info.perfectWinner = PlayerType::X;
+			info.xWinChance = 1.0;
+		}
+		else if (HasLine(oCells))
+		{
+			info.perfectWinner = PlayerType::O;
+			info.oWinChance = 1.0;
+		}
+		else if (occupied == fullBoardMask)
+		{
+			info.perfectWinner = PlayerType::None;
+			info.drawChance = 1.0;
+		}
+		else
+		{
+			PlayerType mover = (CountBits(xCells) == CountBits(oCells)) ? PlayerType::X : PlayerType::O;
+			double moveChance = 1.0 / (9 - CountBits(occupied));
+			int bestRank = -1;
+
+			for (int cell = 0; cell < 9; cell++)
+			{
+				uint16_t cellBit = (uint16_t)(1 << cell);
+				if (occupied & cellBit)
+					continue;
+
+				// Copy the child, 'positions' may grow while it is being built
+				int childIndex = (mover == PlayerType::X) ? BuildPosition(xCells | cellBit, oCells)
+					: BuildPosition(xCells, oCells | cellBit);
+				PositionInfo child = positions[childIndex];
+
+				info.xWinChance += child.xWinChance * moveChance;
+				info.oWinChance += child.oWinChance * moveChance;
+				info.drawChance += child.drawChance * moveChance;
+
+				int rank = OutcomeRank(child.perfectWinner, mover);
+				if (rank > bestRank)
+				{
+					bestRank = rank;
+					info.perfectWinner = child.perfectWinner;
+					info.optimalMoves = 0;
+				}
+				if (rank == bestRank)
+				{
+					info.optimalMoves |= cellBit;
+				}
+			}
+		}
+
+		// Stored the way the canonical form sees it
+		info.optimalMoves = boardSymmetries.MapMask(symmetry, info.optimalMoves);
+		positions.push_back(info);
+		positionIndex[key] = (int16_t)(positions.size() - 1);
+		return positionIndex[key];
+	}
+
+	// Maps the TernaryKey of a canonical form to its entry in 'positions', -1 for
+	//   unreachable positions
+	std::vector<int16_t> positionIndex;
+	std::vector<PositionInfo> positions;
+};
+
+GameTreeTable gameTreeTable;
+
+// Decides which cell a player takes on its turn. Players only hold a pointer to a
+//   strategy, so new ones can be added without touching the game logic.
+template <class Rules>
+class MoveStrategy
+{
+public:
+	virtual ~MoveStrategy() {}
+
+	// Name used on the command line and in the results
+	virtual const char* Name() const = 0;
+
+	// Returns the cell (row * N + col) 'currentPlayer' takes. Only called while at least
+	//   one cell is still empty.
+	virtual int ChooseMove(Player<Rules>* currentPlayer, const Game<Rules>* currentGame) = 0;
+
+	// Prints anything the strategy measured during the round and starts measuring again
+	virtual void PrintStats() {}
+};
+
+// Picks a random empty cell
+template <class Rules>
+class RandomMoveStrategy : public MoveStrategy<Rules>
+{
+public:
+	const char* Name() const override
+	{
+		return "random";
+	}
+
+	int ChooseMove(Player<Rules>* currentPlayer, const Game<Rules>* currentGame) override
+	{
+		int possibleMoves[Rules::cellCount];
+		int totalPossibleMoves = 0;
+
+		// Find all valid moves this player can make
+		for (int row = 0; row < Rules::size; row++)
+		{
+			for (int col = 0; col < Rules::size; col++)
+			{
+				if (currentGame->gameBoard[row][col] == PlayerType::None)
+				{
+					possibleMoves[totalPossibleMoves++] = (row * Rules::size) + col;
+				}
+			}
+		}
+
+		// Pick a random valid location
+		int randomMoveIndex = currentPlayer->myRand() % totalPossibleMoves;
+		return possibleMoves[randomMoveIndex];
+	}
+};
+
+// Plays perfectly by looking the move up in the solved game tree
+class PerfectMoveStrategy : public MoveStrategy<ClassicRules>
+{
+public:
+	const char* Name() const override
+	{
+		return "perfect";
+	}
+
+	int ChooseMove(Player<ClassicRules>* /*currentPlayer*/, const Game<ClassicRules>* currentGame) override
+	{
+		return minimaxSolver.PerfectMove(currentGame->xCells, currentGame->oCells);
+	}
+};
+
+// Plays perfectly like PerfectMoveStrategy, but picks a random move whenever several
+//   of them lead to the same outcome.
+class PerfectRandomMoveStrategy : public MoveStrategy<ClassicRules>
+{
+public:
+	const char* Name() const override
+	{
+		return "perfect-random";
+	}
+
+	int ChooseMove(Player<ClassicRules>* currentPlayer, const Game<ClassicRules>* currentGame) override
+	{
+		uint16_t optimalMoves = gameTreeTable.Lookup(currentGame->xCells, currentGame->oCells).optimalMoves;
+		int pick = currentPlayer->myRand() % CountBits(optimalMoves);
+
+		for (int cell = 0; cell < 9; cell++)
+		{
+			if ((optimalMoves & (1 << cell)) && pick-- == 0)
+				return cell;
+		}
+		return -1;
+	}
+};
+
+// Small xorshift generator for the search threads. The playouts need a lot of random
+//   numbers and don't need the quality of mt19937.
+struct FastRand
+{
+	uint64_t state;
+
+	void Seed(uint64_t seed)
+	{
+		state = seed ? seed : 0x9E3779B97F4A7C15ull;
+	}
+
+	// Returns a random number in [0, limit)
+	int Below(int limit)
+	{
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return (int)(((state * 0x2545F4914F6CDD1Dull) >> 32) % (uint64_t)limit);
+	}
+};
+
+// Board used by the search. It is a plain copy of the game board so playouts never touch
+//   the shared game.
+template <class Rules>
+struct SearchBoard
+{
+	using Mask = typename Rules::Mask;
+
+	PlayerType gameBoard[Rules::size][Rules::size];
+	Mask xCells;
+	Mask oCells;
+	int moveCount;
+	PlayerType toMove;
+
+	void CopyFrom(const Game<Rules>* game, PlayerType mover)
+	{
+		memcpy(gameBoard, game->gameBoard, sizeof(gameBoard));
+		xCells = game->xCells;
+		oCells = game->oCells;
+		moveCount = game->moveCount;
+		toMove = mover;
+	}
+
+	// Takes 'cell' for the side to move and returns true if that won the game
+	bool Play(int cell)
+	{
+		int row = cell / Rules::size;
+		int col = cell % Rules::size;
+		PlayerType mover = toMove;
+		Mask& cells = (mover == PlayerType::X) ? xCells : oCells;
+
+		gameBoard[row][col] = mover;
+		cells |= Rules::CellBit(cell);
+		moveCount++;
+		toMove = (mover == PlayerType::X) ? PlayerType::O : PlayerType::X;
+
+		return IsWinningMove<Rules>(gameBoard, cells, row, col, mover);
+	}
+
+	// Plays random moves until the game is over and returns the winner, PlayerType::None for a draw
+	PlayerType RandomPlayout(FastRand& rand) const
+	{
+		SearchBoard playout = *this;
+		int emptyCells[Rules::cellCount];
+		int emptyCount = 0;
+
+		for (int cell = 0; cell < Rules::cellCount; cell++)
+		{
+			if (playout.gameBoard[cell / Rules::size][cell % Rules::size] == PlayerType::None)
+				emptyCells[emptyCount++] = cell;
+		}
+
+		while (emptyCount > 0)
+		{
+			int pick = rand.Below(emptyCount);
+			int cell = emptyCells[pick];
+			emptyCells[pick] = emptyCells[--emptyCount];
+
+			PlayerType mover = playout.toMove;
+			if (playout.Play(cell))
+				return mover;
+		}
+		return PlayerType::None;
+	}
+};
+
+// Monte Carlo tree search using UCT and random playouts. With more than one search thread
+//   it either grows an independent tree per thread and merges the root statistics (root
+//   parallelization) or grows one tree and runs a playout per thread from every new leaf
+//   (leaf parallelization).
+template <class Rules>
+class MctsMoveStrategy : public MoveStrategy<Rules>
+{
+public:
+	const char* Name() const override
+	{
+		return "mcts";
+	}
+
+	int ChooseMove(Player<Rules>* currentPlayer, const Game<Rules>* currentGame) override
+	{
+		auto searchStart = std::chrono::steady_clock::now();
+
+		SearchBoard<Rules> root;
+		root.CopyFrom(currentGame, currentPlayer->type);
+
+		int threadCount = (simulationSettings.mctsThreads > 0) ? simulationSettings.mctsThreads : 1;
+		uint64_t playouts = 0;
+		int move;
+
+		if (threadCount == 1)
+		{
+			SearchTree tree;
+			FastRand rand;
+			rand.Seed(((uint64_t)currentPlayer->myRand() << 32) | (uint64_t)currentPlayer->myRand());
+			tree.Search(root, rand, searchStart, simulationSettings.mctsPlayouts, nullptr);
+			playouts = tree.playouts;
+			move = tree.MostVisitedMove(nullptr);
+		}
+		else if (simulationSettings.mctsLeafParallel)
+		{
+			playouts = LeafParallelSearch(currentPlayer, root, threadCount, searchStart, &move);
+		}
+		else
+		{
+			playouts = RootParallelSearch(currentPlayer, root, threadCount, searchStart, &move);
+		}
+
+		auto searchTime = std::chrono::steady_clock::now() - searchStart;
+		totalPlayouts += playouts;
+		totalSearchNanoseconds += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(searchTime).count();
+		totalSearches++;
+
+		return move;
+	}
+
+	void PrintStats() override
+	{
+		uint64_t playouts = totalPlayouts.exchange(0);
+		uint64_t nanoseconds = totalSearchNanoseconds.exchange(0);
+		uint64_t searches = totalSearches.exchange(0);
+		if (searches == 0)
+			return;
+
+		double seconds = nanoseconds / 1e9;
+		Log("********* MCTS Search **********\n");
+		Log("%llu searches, %llu playouts, %.3f s searching, %.0f playouts/sec, %.1f playouts per move (%d thread(s), %s parallel)\n\n\n",
+			(unsigned long long)searches, (unsigned long long)playouts, seconds,
+			(seconds > 0.0) ? playouts / seconds : 0.0, (double)playouts / searches,
+			simulationSettings.mctsThreads, simulationSettings.mctsLeafParallel ? "leaf" : "root");
+	}
+
+private:
+	using Mask = typename Rules::Mask;
+	using Clock = std::chrono::steady_clock;
+
+	// Exploration constant of UCT, sqrt(2)
+	static constexpr double exploration = 1.41421356;
+
+	struct Node
+	{
+		int parent;
+		int firstChild;
+		int nextSibling;
+		// Cell taken to reach this node and the side that took it
+		int move;
+		PlayerType mover;
+		// Set once the game is over in this node
+		bool terminal;
+		PlayerType winner;
+		// Empty cells that don't have a child yet
+		Mask untried;
+		int untriedCount;
+		uint32_t visits;
+		// Sum of the playout rewards for 'mover', a win is 1 and a draw is half
+		double reward;
+	};
+
+	// Playouts from one leaf, shared with the helper threads during leaf parallelization
+	struct LeafBatch
+	{
+		std::atomic<uint64_t> generation{ 0 };
+		std::atomic<int> pending{ 0 };
+		std::atomic<int> xWins{ 0 };
+		std::atomic<int> oWins{ 0 };
+		std::atomic<bool> stop{ false };
+		SearchBoard<Rules> leaf;
+	};
+
+	struct SearchTree
+	{
+		std::vector<Node> nodes;
+		uint64_t playouts = 0;
+
+		// Grows the tree until the time or playout budget runs out. With a 'batch' every
+		//   new leaf is also handed to the helper threads waiting on it.
+		void Search(const SearchBoard<Rules>& root, FastRand& rand, Clock::time_point searchStart, int playoutBudget, LeafBatch* batch)
+		{
+			nodes.clear();
+			nodes.push_back(NewNode(-1, -1, (root.toMove == PlayerType::X) ? PlayerType::O : PlayerType::X, root));
+
+			const int helperCount = batch ? simulationSettings.mctsThreads - 1 : 0;
+			const auto deadline = searchStart + std::chrono::milliseconds(simulationSettings.mctsTimeMs);
+
+			while (simulationSettings.mctsTimeMs > 0 ? Clock::now() < deadline : playouts < (uint64_t)playoutBudget)
+			{
+				SearchBoard<Rules> board = root;
+				int nodeIndex = 0;
+
+				// Selection, follow the best UCT score down to a node with untried moves
+				while (!nodes[nodeIndex].terminal && nodes[nodeIndex].untriedCount == 0)
+				{
+					nodeIndex = SelectChild(nodeIndex);
+					board.Play(nodes[nodeIndex].move);
+				}
+
+				// Expansion, add one random untried move
+				if (!nodes[nodeIndex].terminal)
+				{
+					int pick = rand.Below(nodes[nodeIndex].untriedCount);
+					int cell = 0;
+					for (;; cell++)
+					{
+						if (IsSet(nodes[nodeIndex].untried, cell) && pick-- == 0)
+							break;
+					}
+
+					nodes[nodeIndex].untried &= (Mask)~Rules::CellBit(cell);
+					nodes[nodeIndex].untriedCount--;
+
+					PlayerType mover = board.toMove;
+					bool won = board.Play(cell);
+					Node child = NewNode(nodeIndex, cell, mover, board);
+					if (won)
+					{
+						child.terminal = true;
+						child.winner = mover;
+					}
+
+					child.nextSibling = nodes[nodeIndex].firstChild;
+					nodes.push_back(child);
+					nodes[nodeIndex].firstChild = (int)nodes.size() - 1;
+					nodeIndex = (int)nodes.size() - 1;
+				}
+
+				// Simulation, finished games don't need a playout
+				int xWins = 0;
+				int oWins = 0;
+				int rollouts = 1;
+				const Node& leaf = nodes[nodeIndex];
+				if (leaf.terminal)
+				{
+					xWins = (leaf.winner == PlayerType::X);
+					oWins = (leaf.winner == PlayerType::O);
+				}
+				else
+				{
+					if (helperCount > 0)
+					{
+						batch->leaf = board;
+						batch->xWins = 0;
+						batch->oWins = 0;
+						batch->pending = helperCount;
+						batch->generation.fetch_add(1, std::memory_order_release);
+					}
+
+					PlayerType winner = board.RandomPlayout(rand);
+					xWins = (winner == PlayerType::X);
+					oWins = (winner == PlayerType::O);
+
+					if (helperCount > 0)
+					{
+						while (batch->pending.load(std::memory_order_acquire) != 0)
+							std::this_thread::yield();
+
+						xWins += batch->xWins;
+						oWins += batch->oWins;
+						rollouts += helperCount;
+					}
+				}
+				playouts += rollouts;
+
+				// Backpropagation
+				for (int i = nodeIndex; i != -1; i = nodes[i].parent)
+				{
+					Node& node = nodes[i];
+					int wins = (node.mover == PlayerType::X) ? xWins : oWins;
+					int losses = (node.mover == PlayerType::X) ? oWins : xWins;
+					node.visits += rollouts;
+					node.reward += wins + 0.5 * (rollouts - wins - losses);
+				}
+			}
+		}
+
+		int SelectChild(int parentIndex) const
+		{
+			const double logVisits = std::log((double)nodes[parentIndex].visits);
+			int best = -1;
+			double bestScore = -1.0;
+
+			for (int i = nodes[parentIndex].firstChild; i != -1; i = nodes[i].nextSibling)
+			{
+				const Node& child = nodes[i];
+				double score = child.reward / child.visits + exploration * std::sqrt(logVisits / child.visits);
+				if (score > bestScore)
+				{
+					bestScore = score;
+					best = i;
+				}
+			}
+			return best;
+		}
+
+		// Returns the root move with the most visits. 'visitsPerCell' adds up the root
+		//   visits of every tree for root parallelization.
+		int MostVisitedMove(uint64_t* visitsPerCell) const
+		{
+			int best = -1;
+			uint32_t bestVisits = 0;
+
+			for (int i = nodes[0].firstChild; i != -1; i = nodes[i].nextSibling)
+			{
+				if (visitsPerCell)
+					visitsPerCell[nodes[i].move] += nodes[i].visits;
+				if (best == -1 || nodes[i].visits > bestVisits)
+				{
+					bestVisits = nodes[i].visits;
+					best = nodes[i].move;
+				}
+			}
+			return best;
+		}
+
+		static bool IsSet(const Mask& mask, int cell)
+		{
+			if constexpr (Rules::hasBitboard)
+				return (mask >> cell) & 1;
+			else
+				return mask.test(cell);
+		}
+
+		static Node NewNode(int parent, int move, PlayerType mover, const SearchBoard<Rules>& board)
+		{
+			Node node;
+			node.parent = parent;
+			node.firstChild = -1;
+			node.nextSibling = -1;
+			node.move = move;
+			node.mover = mover;
+			node.winner = PlayerType::None;
+			node.terminal = board.moveCount == Rules::cellCount;
+			node.untried = (Mask)~(board.xCells | board.oCells);
+			if constexpr (Rules::hasBitboard && Rules::cellCount < (int)sizeof(Mask) * 8)
+			{
+				// Clear the bits past the last cell
+				node.untried &= (Mask)(((Mask)1 << Rules::cellCount) - 1);
+			}
+			node.untriedCount = Rules::cellCount - board.moveCount;
+			node.visits = 0;
+			node.reward = 0.0;
+			return node;
+		}
+	};
+
+	uint64_t RootParallelSearch(Player<Rules>* currentPlayer, const SearchBoard<Rules>& root, int threadCount, Clock::time_point searchStart, int* move)
+	{
+		std::vector<SearchTree> trees(threadCount);
+		std::vector<FastRand> rands(threadCount);
+		std::vector<std::thread> threads;
+
+		// Every tree gets its share of the playout budget
+		int playoutBudget = (simulationSettings.mctsPlayouts + threadCount - 1) / threadCount;
+		for (int i = 0; i < threadCount; i++)
+		{
+			rands[i].Seed(((uint64_t)currentPlayer->myRand() << 32) | (uint64_t)currentPlayer->myRand());
+		}
+		for (int i = 1; i < threadCount; i++)
+		{
+			threads.emplace_back([&, i] { trees[i].Search(root, rands[i], searchStart, playoutBudget, nullptr); });
+		}
+		trees[0].Search(root, rands[0], searchStart, playoutBudget, nullptr);
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		// Merge the root statistics and pick the move with the most visits overall
+		uint64_t visitsPerCell[Rules::cellCount] = {};
+		uint64_t playouts = 0;
+		for (SearchTree& tree : trees)
+		{
+			tree.MostVisitedMove(visitsPerCell);
+			playouts += tree.playouts;
+		}
+
+		*move = -1;
+		for (int cell = 0; cell < Rules::cellCount; cell++)
+		{
+			if (visitsPerCell[cell] > 0 && (*move == -1 || visitsPerCell[cell] > visitsPerCell[*move]))
+				*move = cell;
+		}
+		return playouts;
+	}
+
+	uint64_t LeafParallelSearch(Player<Rules>* currentPlayer, const SearchBoard<Rules>& root, int threadCount, Clock::time_point searchStart, int* move)
+	{
+		LeafBatch batch;
+		std::vector<std::thread> helpers;
+
+		// Helpers wait for a new leaf, play it out once and report back
+		for (int i = 1; i < threadCount; i++)
+		{
+			uint64_t seed = ((uint64_t)currentPlayer->myRand() << 32) | (uint64_t)currentPlayer->myRand();
+			helpers.emplace_back([&batch, seed]
+				{
+					FastRand rand;
+					rand.Seed(seed);
+					uint64_t seenGeneration = 0;
+
+					while (!batch.stop.load(std::memory_order_acquire))
+					{
+						uint64_t generation = batch.generation.load(std::memory_order_acquire);
+						if (generation == seenGeneration)
+						{
+							std::this_thread::yield();
+							continue;
+						}
+
+						seenGeneration = generation;
+						PlayerType winner = batch.leaf.RandomPlayout(rand);
+						if (winner == PlayerType::X)
+							batch.xWins++;
+						else if (winner == PlayerType::O)
+							batch.oWins++;
+						batch.pending.fetch_sub(1, std::memory_order_release);
+					}
+				});
+		}
+
+		SearchTree tree;
+		FastRand rand;
+		rand.Seed(((uint64_t)currentPlayer->myRand() << 32) | (uint64_t)currentPlayer->myRand());
+		tree.Search(root, rand, searchStart, simulationSettings.mctsPlayouts, &batch);
+
+		batch.stop = true;
+		for (std::thread& helper : helpers)
+		{
+			helper.join();
+		}
+
+		*move = tree.MostVisitedMove(nullptr);
+		return tree.playouts;
+	}
+
+	std::atomic<uint64_t> totalPlayouts{ 0 };
+	std::atomic<uint64_t> totalSearchNanoseconds{ 0 };
+	std::atomic<uint64_t> totalSearches{ 0 };
+};
+
+template <class Rules>
+RandomMoveStrategy<Rules> randomMoveStrategy;
+template <class Rules>
+MctsMoveStrategy<Rules> mctsMoveStrategy;
+PerfectMoveStrategy perfectMoveStrategy;
+PerfectRandomMoveStrategy perfectRandomMoveStrategy;
+
+// Returns the strategy with the given name or nullptr if there isn't one for this board
+template <class Rules>
+MoveStrategy<Rules>* FindMoveStrategy(const std::string& name)
+{
+	std::vector<MoveStrategy<Rules>*> allStrategies = { &randomMoveStrategy<Rules>, &mctsMoveStrategy<Rules> };
+	if constexpr (std::is_same<Rules, ClassicRules>::value)
+	{
+		// The solved game tree only exists for the classic board
+		allStrategies.push_back(&perfectMoveStrategy);
+		allStrategies.push_back(&perfectRandomMoveStrategy);
+	}
+
+	for (MoveStrategy<Rules>* strategy : allStrategies)
+	{
+		if (name == strategy->Name())
+			return strategy;
+	}
+	return nullptr;
+}
+
+// Seed of the cell hashes position keys on bigger boards are made of
+const uint64_t positionHashSeed = 0x5A17C0DE5EEDull;
+
+// Counts every position 'currentGame' went through in its first positionStatsDepth moves,
+//   the empty board included, in 'stats'. On the classic board positions are keyed on their
+//   canonical form so the 8 images of a position share one entry. Bigger boards have no
+//   symmetry tables and key on a hash of the cells each side holds.
+template <class Rules>
+void RecordGamePositions(PositionStats* stats, const Game<Rules>* currentGame, PlayerType winner)
+{
+	int lastPly = std::min(currentGame->moveCount, simulationSettings.positionStatsDepth);
+	if constexpr (std::is_same<Rules, ClassicRules>::value)
+	{
+		uint16_t cells[2] = { 0, 0 };
+		for (int ply = 0; ply <= lastPly; ply++)
+		{
+			uint16_t canonicalX;
+			uint16_t canonicalO;
+			boardSymmetries.Canonicalize(cells[0], cells[1], &canonicalX, &canonicalO);
+			stats->Record((uint64_t)BoardKey(canonicalX, canonicalO), ply, winner);
+
+			// 'X' makes the even moves
+			if (ply < lastPly)
+				cells[ply % 2] |= (uint16_t)(1 << currentGame->moves[ply]);
+		}
+	}
+	else
+	{
+		uint64_t hash = 0;
+		for (int ply = 0; ply <= lastPly; ply++)
+		{
+			stats->Record(hash, ply, winner);
+			if (ply < lastPly)
+				hash ^= MixSeed(positionHashSeed, (uint64_t)currentGame->moves[ply] * 2 + (ply % 2));
+		}
+	}
+}
+
+// Returns the move code GameOutcome stores for 'currentGame', only boards of up to 9 cells
+//   have one
+template <class Rules>
+uint32_t OutcomeMoveCodeOf(const Game<Rules>* currentGame)
+{
+	if constexpr (Rules::cellCount <= 9)
+		return (uint32_t)EncodeMoveSequence(currentGame->moves, currentGame->moveCount, Rules::cellCount);
+	else
+		return 0;
+}
+
+// Play the entire game of Tic-Tac-Toe as 'currentPlayer' in 'currentGame'
+template <class Rules>
+GameState MakeAMove(Player<Rules>* currentPlayer, Game<Rules>* currentGame)
+{
+	if (currentGame->moveCount != Rules::cellCount)
+	{
+		// There are valid moves left on the board, let the player's strategy pick one
+		int move = currentPlayer->strategy->ChooseMove(currentPlayer, currentGame);
+
+		int row = move / Rules::size;
+		int col = move % Rules::size;
+		currentGame->gameBoard[row][col] = currentPlayer->type;
+		currentGame->moves[currentGame->moveCount] = (uint8_t)move;
+		if (currentPlayer->type == PlayerType::X)
+			currentGame->xCells |= Rules::CellBit(move);
+		else
+			currentGame->oCells |= Rules::CellBit(move);
+		currentGame->moveCount++;
+
+		LogVerbose("Game %lld: Player %d: Picked [Row: %d, Col: %d]\n", (long long)currentGame->gameNumber, currentPlayer->id, row, col);
+
+		if (DidWeWin(row, col, currentGame, currentPlayer))
+		{
+			LogVerbose("Game %lld:Player %d - Won\n", (long long)currentGame->gameNumber, currentPlayer->id);
+			currentPlayer->winCount++;
+
+			return GameState::Won;
+		}
+		else
+		{
+			return GameState::StillPlaying;
+		}
+	}
+
+	// There are no more moves left, game resulted in a draw.
+	LogVerbose("Game %lld:Player %d - Draw\n", (long long)currentGame->gameNumber, currentPlayer->id);
+	currentPlayer->drawCount++;
+
+	return GameState::Draw;
+}
+
+// Stores the game 'playerX' and 'playerO' play against each other in 'round'
+void ScheduleGame(TournamentSchedule* schedule, int64_t round, int64_t gameIndex, int playerX, int playerO)
+{
+	schedule->slots[(size_t)round * schedule->playerCount + playerX] = gameIndex * 2 + 1;
+	schedule->slots[(size_t)round * schedule->playerCount + playerO] = gameIndex * 2;
+	schedule->xGames[playerX]++;
+	schedule->games[playerX]++;
+	schedule->games[playerO]++;
+	schedule->lastOpponent[playerX] = playerO;
+	schedule->lastOpponent[playerO] = playerX;
+}
+
+// Pairs 'order' two by two into the games of 'round'. The player with fewer 'X' games so
+//   far gets to be 'X'. Pairs past the last game of the tournament sit the round out.
+void ScheduleOrderedPairs(TournamentSchedule* schedule, int64_t round, const std::vector<int>& order)
+{
+	int64_t firstGame = round * schedule->gamesPerRound;
+
+	for (int pair = 0; pair < schedule->gamesPerRound; pair++)
+	{
+		int64_t gameIndex = firstGame + pair;
+		if (gameIndex >= schedule->totalGameCount)
+			break;
+
+		int a = order[pair * 2];
+		int b = order[pair * 2 + 1];
+		if (schedule->xGames[a] <= schedule->xGames[b])
+			ScheduleGame(schedule, round, gameIndex, a, b);
+		else
+			ScheduleGame(schedule, round, gameIndex, b, a);
+	}
+}
+
+// Removes the player who sits out 'round' from 'order' when the player count is odd. The
+//   bye goes to the last player in 'order' with the fewest byes so far.
+void TakeOutBye(TournamentSchedule* schedule, std::vector<int>& order)
+{
+	if (order.size() % 2 == 0)
+		return;
+
+	size_t byePosition = order.size() - 1;
+	for (size_t i = order.size(); i-- > 0;)
+	{
+		if (schedule->byes[order[i]] < schedule->byes[order[byePosition]])
+			byePosition = i;
+	}
+
+	schedule->byes[order[byePosition]]++;
+	order.erase(order.begin() + byePosition);
+}
+
+// Returns the players of the short last round of a round robin, the ones with the fewest
+//   games first. Every full cycle gives everybody the same number of games, so only an odd
+//   player count leaves anyone behind: the players who had a bye earlier in the current
+//   cycle, and they go first.
+std::vector<int> ShortRoundRobinOrder(const TournamentSchedule* schedule, int64_t round)
+{
+	const int playerCount = schedule->playerCount;
+	int seatCount = playerCount + (playerCount % 2);
+	int cycleLength = seatCount - 1;
+	int step = (int)(round % cycleLength);
+
+	std::vector<int> order;
+	std::vector<bool> ordered(playerCount, false);
+	if (playerCount % 2 == 1)
+	{
+		// Whoever sits across from the extra seat has the bye, see RoundRobinSlot
+		for (int earlierStep = 0; earlierStep < step; earlierStep++)
+		{
+			int extraSeat = 1 + (playerCount - 1 - earlierStep + cycleLength) % cycleLength;
+			int byeSeat = seatCount - 1 - extraSeat;
+			int byePlayer = (byeSeat == 0) ? 0 : 1 + (byeSeat - 1 + earlierStep) % cycleLength;
+			order.push_back(byePlayer);
+			ordered[byePlayer] = true;
+		}
+	}
+	for (int i = 0; i < playerCount; i++)
+	{
+		if (!ordered[i])
+			order.push_back(i);
+	}
+	return order;
+}
+
+// Returns the schedule entry of 'playerId' in round robin 'round'. This is the circle
+//   method: seat 0 stays put while everybody else moves one seat each round, and seat i
+//   plays the seat across from it. With an odd player count the extra seat is a bye.
+int64_t RoundRobinSlot(const TournamentSchedule* schedule, int64_t round, int playerId)
+{
+	const int playerCount = schedule->playerCount;
+	int seatCount = playerCount + (playerCount % 2);
+	int cycleLength = seatCount - 1;
+	int step = (int)(round % cycleLength);
+	bool swapColors = (round / cycleLength) % 2 == 1;
+
+	// A short last round pairs the players with the fewest games two by two instead
+	int64_t firstGame = round * schedule->gamesPerRound;
+	if (firstGame + schedule->gamesPerRound > schedule->totalGameCount)
+	{
+		std::vector<int> order = ShortRoundRobinOrder(schedule, round);
+		int64_t position = std::find(order.begin(), order.end(), playerId) - order.begin();
+		if (position >= 2 * (schedule->totalGameCount - firstGame))
+			return -1;
+		return (firstGame + position / 2) * 2 + ((position % 2 == 0) != swapColors ? 1 : 0);
+	}
+
+	// Player p > 0 sits in seat 1 + (p - 1 - step) mod cycleLength
+	auto seatOf = [&](int player) { return (player == 0) ? 0 : 1 + (player - 1 - step + cycleLength) % cycleLength; };
+	auto playerIn = [&](int seat) { return (seat == 0) ? 0 : 1 + (seat - 1 + step) % cycleLength; };
+
+	int seat = seatOf(playerId);
+	int opponentSeat = seatCount - 1 - seat;
+	if (playerIn(opponentSeat) >= playerCount)
+		return -1;
+
+	// Tables are numbered from seat 0 inward, the table with the bye has no game
+	int table = (seat < opponentSeat) ? seat : opponentSeat;
+	int pair = table;
+	if (playerCount % 2 == 1)
+	{
+		int byeSeat = seatOf(playerCount);
+		int byeTable = (byeSeat < seatCount - 1 - byeSeat) ? byeSeat : seatCount - 1 - byeSeat;
+		if (byeTable < table)
+			pair--;
+	}
+
+	int64_t gameIndex = round * schedule->gamesPerRound + pair;
+	if (gameIndex >= schedule->totalGameCount)
+		return -1;
+
+	// Alternate colors between tables and rounds so they even out over a cycle
+	bool lowSeatIsX = ((table + step) % 2 == 0) != swapColors;
+	bool isX = (seat == table) ? lowSeatIsX : !lowSeatIsX;
+	return gameIndex * 2 + (isX ? 1 : 0);
+}
+
+// Pairs one schedule round. Round robin and random pairings don't depend on any results,
+//   Swiss pairings need every game of the previous round to be finished.
+void PairScheduleRound(TournamentSchedule* schedule, int64_t round)
+{
+	const int playerCount = schedule->playerCount;
+	std::vector<int> order;
+
+	if (schedule->type == ScheduleType::RoundRobin)
+	{
+		for (int i = 0; i < playerCount; i++)
+		{
+			schedule->slots[(size_t)round * playerCount + i] = RoundRobinSlot(schedule, round, i);
+		}
+		return;
+	}
+
+	for (int i = 0; i < playerCount; i++)
+	{
+		order.push_back(i);
+	}
+	std::shuffle(order.begin(), order.end(), schedule->shuffleEngine);
+
+	bool swissByScore = schedule->type == ScheduleType::Swiss && round > 0;
+	if (swissByScore)
+	{
+		// Best scores first, the shuffle above breaks ties
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+			{ return schedule->halfPoints[a].load(std::memory_order_relaxed) > schedule->halfPoints[b].load(std::memory_order_relaxed); });
+	}
+
+	int64_t gamesLeft = schedule->totalGameCount - round * schedule->gamesPerRound;
+	if (gamesLeft < schedule->gamesPerRound)
+	{
+		// A short last round goes to the players with the fewest games, the order so far breaks ties
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return schedule->games[a] < schedule->games[b]; });
+		order.resize((size_t)gamesLeft * 2);
+	}
+	else
+	{
+		TakeOutBye(schedule, order);
+	}
+
+	if (swissByScore)
+	{
+		// Avoid an immediate rematch by swapping in the next player down when possible
+		for (size_t i = 0; i + 1 < order.size(); i += 2)
+		{
+			if (schedule->lastOpponent[order[i]] == order[i + 1] && i + 2 < order.size())
+				std::swap(order[i + 1], order[i + 2]);
+		}
+	}
+
+	ScheduleOrderedPairs(schedule, round, order);
+}
+
+// Lays out the schedule for a round of 'totalGameCount' games between 'playerCount' players.
+//   A streaming schedule stores nothing, see TournamentSchedule.
+void BuildSchedule(TournamentSchedule* schedule, ScheduleType type, int playerCount, int64_t totalGameCount, bool streaming, uint64_t seed)
+{
+	schedule->type = type;
+	schedule->playerCount = playerCount;
+	schedule->totalGameCount = totalGameCount;
+	schedule->gamesPerRound = playerCount / 2;
+	schedule->roundCount = (totalGameCount + schedule->gamesPerRound - 1) / schedule->gamesPerRound;
+	schedule->streaming = streaming;
+	if (type == ScheduleType::Queue)
+	{
+		schedule->slots.clear();
+		int shareCount = numaLayout.SplitsGames() ? (int)numaLayout.nodes.size() : 1;
+		schedule->arrivals.reset(new ArrivalCounter[shareCount]);
+		for (int share = 0; share < shareCount; share++)
+		{
+			bool split = numaLayout.SplitsGames();
+			schedule->arrivals[share].next = 2 * (split ? numaLayout.FirstGame(share, totalGameCount) : 0);
+			schedule->arrivals[share].lastGame = split ? numaLayout.FirstGame(share + 1, totalGameCount) : totalGameCount;
+		}
+		schedule->pairedRounds = schedule->roundCount;
+		return;
+	}
+	if (streaming)
+	{
+		schedule->slots.clear();
+		schedule->pairedRounds = schedule->roundCount;
+		return;
+	}
+
+	schedule->slots.assign((size_t)schedule->roundCount * playerCount, -1);
+	schedule->xGames.assign(playerCount, 0);
+	schedule->games.assign(playerCount, 0);
+	schedule->byes.assign(playerCount, 0);
+	schedule->lastOpponent.assign(playerCount, -1);
+	schedule->shuffleEngine.seed((std::mt19937::result_type)seed);
+
+	if (type == ScheduleType::Swiss)
+	{
+		schedule->halfPoints.reset(new std::atomic<int>[playerCount]);
+		schedule->gamesLeftInRound.reset(new std::atomic<int>[schedule->roundCount]);
+		for (int i = 0; i < playerCount; i++)
+		{
+			schedule->halfPoints[i] = 0;
+		}
+		for (int64_t round = 0; round < schedule->roundCount; round++)
+		{
+			int64_t gamesLeft = totalGameCount - round * schedule->gamesPerRound;
+			schedule->gamesLeftInRound[round] = (int)((gamesLeft < schedule->gamesPerRound) ? gamesLeft : schedule->gamesPerRound);
+		}
+
+		PairScheduleRound(schedule, 0);
+		schedule->pairedRounds = 1;
+	}
+	else
+	{
+		for (int64_t round = 0; round < schedule->roundCount; round++)
+		{
+			PairScheduleRound(schedule, round);
+		}
+		schedule->pairedRounds = schedule->roundCount;
+	}
+}
+
+// Called by the player that ended game 'gameIndex' of 'simulationRound'. Stores the outcome
+//   and 'moveCode' when asked to, and for Swiss scores the game and pairs the next round
+//   once the last game of this one is over.
+void RecordScheduledResult(TournamentSchedule* schedule, int simulationRound, int64_t gameIndex, int playerX, int playerO, PlayerType winner,
+	uint32_t moveCode)
+{
+	if (schedule->outcomes)
+	{
+		GameOutcome& outcome = schedule->outcomes[simulationRound * schedule->totalGameCount + gameIndex];
+		outcome.playerX = playerX;
+		outcome.playerO = playerO;
+		outcome.winner = (uint8_t)winner;
+		outcome.moveCode[0] = (uint8_t)moveCode;
+		outcome.moveCode[1] = (uint8_t)(moveCode >> 8);
+		outcome.moveCode[2] = (uint8_t)(moveCode >> 16);
+	}
+
+	if (schedule->type != ScheduleType::Swiss)
+		return;
+
+	schedule->halfPoints[playerX].fetch_add((winner == PlayerType::X) ? 2 : (winner == PlayerType::None) ? 1 : 0, std::memory_order_relaxed);
+	schedule->halfPoints[playerO].fetch_add((winner == PlayerType::O) ? 2 : (winner == PlayerType::None) ? 1 : 0, std::memory_order_relaxed);
+
+	int64_t round = gameIndex / schedule->gamesPerRound;
+	if (schedule->gamesLeftInRound[round].fetch_sub(1, std::memory_order_acq_rel) == 1 && round + 1 < schedule->roundCount)
+	{
+		std::lock_guard<std::mutex> pairingLock(schedule->pairingMutex);
+		PairScheduleRound(schedule, round + 1);
+		schedule->pairedRounds = round + 2;
+		schedule->pairingCondition.notify_all();
+	}
+}
+
+// Returns the slot of 'playerId' in 'round', waiting for the round to be paired first
+int64_t WaitForScheduleSlot(TournamentSchedule* schedule, int64_t round, int playerId)
+{
+	if (schedule->streaming)
+		return RoundRobinSlot(schedule, round, playerId);
+
+	if (schedule->type == ScheduleType::Swiss)
+	{
+		std::unique_lock<std::mutex> pairingLock(schedule->pairingMutex);
+		schedule->pairingCondition.wait(pairingLock, [&] { return schedule->pairedRounds > round; });
+	}
+	return schedule->slots[(size_t)round * schedule->playerCount + playerId];
+}
+
+// Returns the entry in perGameData that hosts game 'gameIndex'. When streaming there is
+//   one entry per table and schedule round r + 1 reuses the entries of round r.
+int64_t GameSlotOf(const TournamentSchedule* schedule, int64_t gameIndex)
+{
+	return schedule->streaming ? gameIndex % schedule->gamesPerRound : gameIndex;
+}
+
+// Returns the position of game 'gameIndex' of simulation round 'round' in the sequence
+//   of games its entry hosts. The tickets of an entry go up by exactly one from game to
+//   game, which lets a player tell whether the game before its own is over.
+int64_t GameTicket(const TournamentSchedule* schedule, int64_t round, int64_t gameIndex)
+{
+	if (!schedule->streaming)
+		return round;
+
+	// Number of games an entry hosts in each simulation round
+	int64_t slot = GameSlotOf(schedule, gameIndex);
+	int64_t gamesPerSlot = (schedule->totalGameCount - slot + schedule->gamesPerRound - 1) / schedule->gamesPerRound;
+	return round * gamesPerSlot + gameIndex / schedule->gamesPerRound;
+}
+
+// Rating every player starts with
+const int64_t initialMilliRating = 1500 * 1000;
+
+// Sets every player to the initial rating. The ratings live in 'sharedMilliRatings' when
+//   given, otherwise the table allocates them itself.
+void InitRatings(RatingTable* ratings, int playerCount, double kFactor, std::atomic<int64_t>* sharedMilliRatings)
+{
+	ratings->playerCount = playerCount;
+	ratings->kFactor = kFactor;
+	if (sharedMilliRatings == nullptr)
+	{
+		ratings->ownedMilliRatings.reset(new std::atomic<int64_t>[playerCount]);
+		sharedMilliRatings = ratings->ownedMilliRatings.get();
+	}
+	ratings->milliRatings = sharedMilliRatings;
+	ratings->roundStartMilliRatings.assign(playerCount, initialMilliRating);
+	for (int i = 0; i < playerCount; i++)
+	{
+		ratings->milliRatings[i] = initialMilliRating;
+	}
+}
+
+// Applies the Elo update for one finished game. Called by the player that ended the game,
+//   both ratings move by the same amount in opposite directions.
+void UpdateRatings(RatingTable* ratings, int playerX, int playerO, PlayerType winner)
+{
+	double ratingX = ratings->milliRatings[playerX].load(std::memory_order_relaxed) / 1000.0;
+	double ratingO = ratings->milliRatings[playerO].load(std::memory_order_relaxed) / 1000.0;
+
+	double expectedX = 1.0 / (1.0 + std::pow(10.0, (ratingO - ratingX) / 400.0));
+	double scoreX = (winner == PlayerType::X) ? 1.0 : (winner == PlayerType::None) ? 0.5 : 0.0;
+	int64_t change = (int64_t)std::llround(ratings->kFactor * (scoreX - expectedX) * 1000.0);
+
+	ratings->milliRatings[playerX].fetch_add(change, std::memory_order_relaxed);
+	ratings->milliRatings[playerO].fetch_sub(change, std::memory_order_relaxed);
+}
+
+// Nanoseconds on a clock that only ever moves forward
+inline int64_t HandoffClock()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Notes when and from where 'currentPlayer' hands the turn over to its opponent
+template <class Rules>
+void PassTurn(const Player<Rules>* currentPlayer, Game<Rules>* currentGame)
+{
+	currentGame->passerCpu = currentPlayer->cpu;
+	currentGame->passerCore = currentPlayer->core;
+	currentGame->passerCacheDomain = currentPlayer->cacheDomain;
+	currentGame->turnPassedAt = HandoffClock();
+}
+
+// Counts the turn the opponent passed to 'currentPlayer', by how far apart the two are pinned
+template <class Rules>
+void CountHandoff(Player<Rules>* currentPlayer, const Game<Rules>* currentGame)
+{
+	HandoffDistance distance = HandoffRemote;
+	if (currentPlayer->cpu < 0 || currentGame->passerCpu < 0)
+		distance = HandoffUnpinned;
+	else if (currentPlayer->core == currentGame->passerCore)
+		distance = HandoffSameCore;
+	else if (currentPlayer->cacheDomain == currentGame->passerCacheDomain)
+		distance = HandoffSameCache;
+
+	currentPlayer->handoffs[distance]++;
+	currentPlayer->handoffNanoseconds[distance] += HandoffClock() - currentGame->turnPassedAt;
+}
+
+// Play the entire game of Tic-Tac-Toe as 'currentPlayer' in 'currentGame'. 'gameUniqueLock'
+//   holds the game's mutex and is released while waiting for the other player.
+template <class Rules>
+void PlayGame(Player<Rules>* currentPlayer, Game<Rules>* currentGame, std::unique_lock<std::mutex>& gameUniqueLock)
+{
+	LogVerbose("Game %lld:Player %d vs Player %d (Player %d) starting\n", (long long)currentGame->gameNumber, currentGame->playerX, currentGame->playerO, currentPlayer->id);
+
+	if (currentGame->playerO == -1 || currentGame->playerX == -1)
+	{
+		Log("ERROR: Playing game with only one player present. Did you forget to wait for the second player in JoinGame()?\n");
+		Pause();
+		exit(1);
+	}
+
+	while (true)
+	{
+		// Wait until it is our turn or the other player ended the game
+		currentGame->gameCondition.wait(gameUniqueLock, [&]
+			{ return currentGame->currentTurn == currentPlayer->type || currentGame->currentGameState != GameState::StillPlaying; });
+
+		if (currentGame->currentGameState != GameState::StillPlaying)
+			break;
+
+		if (simulationSettings.handoffStats && currentGame->moveCount > 0)
+			CountHandoff(currentPlayer, currentGame);
+
+		currentGame->currentTurn = (currentPlayer->type == PlayerType::X) ? PlayerType::O : PlayerType::X;
+
+		// Make a move on the game board
+		currentGame->currentGameState = MakeAMove(currentPlayer, currentGame);
+		PrintGameBoard(currentGame);
+
+		switch (currentGame->currentGameState)
+		{
+		case GameState::StillPlaying:
+
+			// The game is not over yet. 
+			if (simulationSettings.handoffStats)
+				PassTurn(currentPlayer, currentGame);
+			currentGame->gameCondition.notify_all();
+
+			continue;
+
+		case GameState::Won:
+			// We have won the game
+			currentPlayer->gamesEndedWon++;
+			if (currentPlayer->type == PlayerType::X)
+				currentPlayer->gamesEndedWonAsX++;
+			RecordScheduledResult(currentPlayer->gamePool->schedule, currentPlayer->round, currentGame->gameNumber - 1,
+				currentGame->playerX, currentGame->playerO, currentPlayer->type, OutcomeMoveCodeOf(currentGame));
+			if (currentPlayer->positionStats.Enabled())
+				RecordGamePositions(&currentPlayer->positionStats, currentGame, currentPlayer->type);
+			UpdateRatings(currentPlayer->playerPool->ratings, currentGame->playerX, currentGame->playerO, currentPlayer->type);
+			currentGame->gameCondition.notify_all();
+
+			return;
+
+		case GameState::Draw:
+
+			// The game ended in a tie
+			currentPlayer->gamesEndedDraw++;
+			RecordScheduledResult(currentPlayer->gamePool->schedule, currentPlayer->round, currentGame->gameNumber - 1,
+				currentGame->playerX, currentGame->playerO, PlayerType::None, OutcomeMoveCodeOf(currentGame));
+			if (currentPlayer->positionStats.Enabled())
+				RecordGamePositions(&currentPlayer->positionStats, currentGame, PlayerType::None);
+			UpdateRatings(currentPlayer->playerPool->ratings, currentGame->playerX, currentGame->playerO, PlayerType::None);
+			currentGame->gameCondition.notify_all();
+
+			return;
+		}
+	}
+
+	// Only one player will execute this logic. The winning/Tied player will exit this function
+	//   upon finding out the game is over.
+	if (currentGame->currentGameState == GameState::Won)
+	{
+		LogVerbose("Game %lld:Player %d - Lost\n", (long long)currentGame->gameNumber, currentPlayer->id);
+		(currentPlayer->loseCount)++;
+	}
+	else if (currentGame->currentGameState == GameState::Draw)
+	{
+		LogVerbose("Game %lld:Player %d - Draw\n", (long long)currentGame->gameNumber, currentPlayer->id);
+		(currentPlayer->drawCount)++; // count draw
+	}
+}
+
+// Clears 'currentGame' to host game 'gameIndex' as ticket 'ticket'
+template <class Rules>
+void ResetGame(Game<Rules>* currentGame, int64_t ticket, int64_t gameIndex)
+{
+	currentGame->ticket = ticket;
+	currentGame->gameNumber = gameIndex + 1;
+	currentGame->playerO = -1;
+	currentGame->playerX = -1;
+	currentGame->currentTurn = PlayerType::X;
+	currentGame->currentGameState = GameState::StillPlaying;
+	currentGame->playerCount = 0;
+	currentGame->playersDone = 0;
+	memset(currentGame->gameBoard, 0, sizeof(currentGame->gameBoard));
+	currentGame->xCells = 0;
+	currentGame->oCells = 0;
+	currentGame->moveCount = 0;
+}
+
+// Tells the CPU this thread is spinning, so a sibling hyperthread gets the core meanwhile
+inline void CpuRelax()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#elif defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+// Waits for the opponent to join 'currentGame'. The opponent usually shows up within
+//   microseconds, so the player first spins for waitSpins rounds and then yields the CPU
+//   waitYields times before it sleeps on the game's condition. Spinning only pays off with
+//   a core per player thread, see ResolveWaitPolicy. Counts which phase ended the wait,
+//   or that the player came second and had nothing to wait for.
+template <class Rules>
+void WaitForOpponent(Player<Rules>* currentPlayer, Game<Rules>* currentGame, std::unique_lock<std::mutex>& gameUniqueLock)
+{
+	if (currentGame->playerCount.load(std::memory_order_relaxed) == 2)
+	{
+		currentPlayer->opponentWaits[WaitSecondArrival]++;
+		return;
+	}
+
+	// Let the opponent in while checking for it from the outside
+	gameUniqueLock.unlock();
+	WaitPhase phase = WaitPark;
+	for (int i = 0; i < simulationSettings.waitSpins && phase == WaitPark; i++)
+	{
+		CpuRelax();
+		if (currentGame->playerCount.load(std::memory_order_acquire) == 2)
+			phase = WaitSpin;
+	}
+	for (int i = 0; i < simulationSettings.waitYields && phase == WaitPark; i++)
+	{
+		std::this_thread::yield();
+		if (currentGame->playerCount.load(std::memory_order_acquire) == 2)
+			phase = WaitYield;
+	}
+	gameUniqueLock.lock();
+
+	currentGame->gameCondition.wait(gameUniqueLock, [&]
+		{return currentGame->playerCount == 2; });
+	currentPlayer->opponentWaits[phase]++;
+}
+
+// Makes 'currentPlayer' join game 'gameIndex' on 'currentGame' as 'type' and waits for
+//  the other scheduled player to show up before playing the game.
+template <class Rules>
+void JoinGame(Player<Rules>* currentPlayer, Game<Rules>* currentGame, PlayerType type, int64_t ticket, int64_t gameIndex)
+{
+	// The player thread has joined a game and will begin playing it now.
+	std::unique_lock<std::mutex> gameUniqueLock(currentGame->gameMutex);
+
+	if (currentGame->ticket != ticket)
+	{
+		// First one here. The players of the game before this one may still be on it,
+		//   so wait for them to leave first.
+		currentGame->gameCondition.wait(gameUniqueLock, [&]
+			{ return currentGame->ticket == ticket || (currentGame->ticket == ticket - 1 && (ticket == 0 || currentGame->playersDone == 2)); });
+
+		if (currentGame->ticket != ticket)
+			ResetGame(currentGame, ticket, gameIndex);
+	}
+
+	LogVerbose("Player %d joining game %lld as '%c'\n", currentPlayer->id, (long long)currentGame->gameNumber, (type == PlayerType::X) ? 'X' : 'O');
+
+	currentPlayer->type = type;
+	if (type == PlayerType::X)
+		currentGame->playerX = currentPlayer->id;
+	else
+		currentGame->playerO = currentPlayer->id;
+
+	// Wait for other player to join the game
+	currentGame->playerCount++;
+	currentGame->gameCondition.notify_all();
+	WaitForOpponent(currentPlayer, currentGame, gameUniqueLock);
+
+	PlayGame(currentPlayer, currentGame, gameUniqueLock);
+	currentPlayer->gamesPlayed++;
+	// A plain store, the player is the only writer
+	currentPlayer->finishedGames.store(currentPlayer->finishedGames.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	currentGame->playersDone++;
+	if (currentGame->playersDone == 2)
+		currentGame->gameCondition.notify_all();
+	gameUniqueLock.unlock();
+}
+
+// Set by InterruptHandler on Ctrl+C
+std::atomic<bool> interruptRequested(false);
+
+// The first Ctrl+C asks the run to stop where it is and still report, the second one
+//   kills it as usual
+extern "C" void InterruptHandler(int)
+{
+	interruptRequested = true;
+	std::signal(SIGINT, SIG_DFL);
+}
+
+// True once the run should stop early, after Ctrl+C or once its time limit is up
+bool RunShouldStop(const PlayerPool* poolOfPlayers)
+{
+	if (interruptRequested)
+		return true;
+	return simulationSettings.timeLimit > 0.0 && std::chrono::steady_clock::now() >= poolOfPlayers->deadline;
+}
+
+// Stops the players as soon as that can be done without leaving anybody waiting for an
+//   opponent. Every player publishes its schedule position before it looks for a stop, and
+//   the stop lands right after the furthest position, so every game somebody may already
+//   be waiting in still gets played. The queue's players close their share themselves.
+template <class Rules>
+void StopPlayers(Player<Rules>* perPlayerData, PlayerPool* poolOfPlayers, int totalPlayerCount)
+{
+	poolOfPlayers->stopRequested = true;
+
+	int64_t furthest = -1;
+	for (int i = 0; i < totalPlayerCount; i++)
+	{
+		furthest = std::max(furthest, perPlayerData[i].schedulePosition.load());
+	}
+	poolOfPlayers->stopPosition = furthest + 1;
+}
+
+// Returns the first schedule position left out once a stop was requested
+int64_t WaitForStopPosition(const PlayerPool* poolOfPlayers)
+{
+	int64_t stopPosition;
+	while ((stopPosition = poolOfPlayers->stopPosition.load(std::memory_order_acquire)) < 0)
+	{
+		std::this_thread::yield();
+	}
+	return stopPosition;
+}
+
+// Added to a queue share's counter to close it, far above any number it hands out
+const int64_t queueClosed = (int64_t)1 << 62;
+
+// Makes the specified player play every game the schedule has for it, in order. Both
+//   players of a game reach it after finishing all of their earlier schedule rounds, so
+//   nobody can end up waiting for an opponent that never comes.
+//   With the queue there is no plan, the player keeps taking games until all are handed out.
+template <class Rules>
+void PlayScheduledGames(Player<Rules>* currentPlayer, int round)
+{
+	LogVerbose("Player %d starting to play games...\n", currentPlayer->id);
+
+	Game<Rules>* listOfGames = currentPlayer->gamePool->perGameData;
+	TournamentSchedule* schedule = currentPlayer->gamePool->schedule;
+
+	if (schedule->type == ScheduleType::Queue)
+	{
+		// A player holding an even number is stuck in its game until somebody takes the odd
+		//   one, so it can never end up paired with itself. Every share has at least two
+		//   players, so the last one of them to come along always finds an opponent.
+		ArrivalCounter* arrivals = &schedule->arrivals[currentPlayer->node];
+		while (true)
+		{
+			int64_t arrival;
+			if (currentPlayer->playerPool->stopRequested.load(std::memory_order_relaxed))
+			{
+				// Close the share. When the last number handed out was even its holder is
+				//   waiting for an opponent, and the player closing the share is it.
+				arrival = arrivals->next.load();
+				while (arrival < queueClosed && !arrivals->next.compare_exchange_weak(arrival, arrival + queueClosed))
+				{
+				}
+				if (arrival >= queueClosed || arrival % 2 == 0)
+					return;
+			}
+			else
+			{
+				arrival = arrivals->next.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			int64_t gameIndex = arrival / 2;
+			if (gameIndex >= arrivals->lastGame)
+				return;
+
+			JoinGame(currentPlayer, &listOfGames[GameSlotOf(schedule, gameIndex)], (arrival % 2 == 0) ? PlayerType::X : PlayerType::O,
+				GameTicket(schedule, round, gameIndex), gameIndex);
+		}
+	}
+
+	PlayerPool* playerPool = currentPlayer->playerPool;
+	for (int64_t scheduleRound = 0; scheduleRound < schedule->roundCount; scheduleRound++)
+	{
+		// Positions have to be published before looking for a stop, see StopPlayers
+		int64_t position = round * schedule->roundCount + scheduleRound;
+		currentPlayer->schedulePosition.store(position);
+		if (playerPool->stopRequested.load() && position >= WaitForStopPosition(playerPool))
+			return;
+
+		int64_t slot = WaitForScheduleSlot(schedule, scheduleRound, currentPlayer->id);
+		if (slot == -1)
+		{
+			// Bye or the tournament ran out of games in this schedule round
+			continue;
+		}
+
+		int64_t gameIndex = slot / 2;
+		JoinGame(currentPlayer, &listOfGames[GameSlotOf(schedule, gameIndex)], (slot % 2) ? PlayerType::X : PlayerType::O,
+			GameTicket(schedule, round, gameIndex), gameIndex);
+	}
+}
+
+// Entry point for player threads. The thread plays rounds [firstRound, lastRound) back
+//   to back, each one starting as soon as this player is done with the previous one.
+template <class Rules>
+void PlayerThreadEntrypoint(Player<Rules>* currentPlayer, int firstRound, int lastRound)
+{
+	LogVerbose("Player %d waiting on starting gun\n", currentPlayer->id);
+
+	// Let main know there's one more player thread running then wait for a notification from main.
+	//   The count is guarded by the mutex main waits on, so main can't miss the notification.
+	currentPlayer->playerPool->totalPlayersMutex.lock();
+	currentPlayer->playerPool->totalPlayerCount++;
+	currentPlayer->playerPool->playerCondition.notify_all();
+	currentPlayer->playerPool->totalPlayersMutex.unlock();
+
+	std::unique_lock<std::mutex> playerLock(currentPlayer->playerPool->playersIncrementMutex);
+	currentPlayer->playerPool->playerIncrementCondition.wait(playerLock, [&]
+		{ return currentPlayer->playerPool->gunFlag; });
+
+	playerLock.unlock();
+
+	for (int round = firstRound; round < lastRound; round++)
+	{
+		// The player resets its own counters, main never has to sweep the players
+		currentPlayer->gamesPlayed = 0;
+		currentPlayer->winCount = 0;
+		currentPlayer->loseCount = 0;
+		currentPlayer->drawCount = 0;
+		currentPlayer->type = PlayerType::None;
+		currentPlayer->round = round;
+		currentPlayer->gamesEndedWon = 0;
+		currentPlayer->gamesEndedDraw = 0;
+		currentPlayer->gamesEndedWonAsX = 0;
+		memset(currentPlayer->opponentWaits, 0, sizeof(currentPlayer->opponentWaits));
+		memset(currentPlayer->handoffs, 0, sizeof(currentPlayer->handoffs));
+		memset(currentPlayer->handoffNanoseconds, 0, sizeof(currentPlayer->handoffNanoseconds));
+
+		TlbCounter tlbCounter;
+		bool countingTlbMisses = simulationSettings.tlbStats && tlbCounter.Open();
+
+		// Attempt to play each game, all of the game logic will occur in this function
+		LogVerbose("Player %d running round %d\n", currentPlayer->id, round + 1);
+		PlayScheduledGames(currentPlayer, round);
+
+		uint64_t dtlbLoadMisses = tlbCounter.ReadAndClose();
+
+		// Fold this player's results into the round's totals. This uses the same mutex main
+		//   waits on so the totals are guaranteed to be visible once main sees every
+		//   player finish the round.
+		currentPlayer->playerPool->totalPlayersMutex.lock();
+		RoundResults& results = currentPlayer->playerPool->roundResults[round];
+		RoundTotals& roundTotals = results.totals;
+		roundTotals.totalGamesWon += currentPlayer->gamesEndedWon;
+		roundTotals.totalGamesWonByX += currentPlayer->gamesEndedWonAsX;
+		roundTotals.totalGamesTied += currentPlayer->gamesEndedDraw;
+		roundTotals.totalPlayerWins += currentPlayer->winCount;
+		roundTotals.totalPlayerLoses += currentPlayer->loseCount;
+		roundTotals.totalPlayerTies += currentPlayer->drawCount;
+		roundTotals.dtlbLoadMisses += dtlbLoadMisses;
+		for (int phase = 0; phase < waitPhaseCount; phase++)
+		{
+			roundTotals.opponentWaits[phase] += currentPlayer->opponentWaits[phase];
+		}
+		for (int distance = 0; distance < handoffDistanceCount; distance++)
+		{
+			roundTotals.handoffs[distance] += currentPlayer->handoffs[distance];
+			roundTotals.handoffNanoseconds[distance] += currentPlayer->handoffNanoseconds[distance];
+		}
+		if (simulationSettings.tlbStats && !countingTlbMisses)
+			roundTotals.tlbCountersUnavailable++;
+
+		PlayerRoundResult& playerResult = results.players[currentPlayer->id];
+		playerResult.gamesPlayed = currentPlayer->gamesPlayed;
+		playerResult.winCount = currentPlayer->winCount;
+		playerResult.loseCount = currentPlayer->loseCount;
+		playerResult.drawCount = currentPlayer->drawCount;
+		results.playersFinished++;
+
+		if (round + 1 == lastRound)
+		{
+			// Let main know there's one less player thread running.
+			currentPlayer->playerPool->totalPlayerCount--;
+		}
+		// Notify before unlocking, once the last player is done main may free the pool and the
+		//   arena this player lives in
+		currentPlayer->playerPool->playerCondition.notify_all();
+		currentPlayer->playerPool->totalPlayersMutex.unlock();
+	}
+}
+
+// Displays the results of all players and all games of one round to the console. The
+//   totals come from the partial sums merged by the player threads, so nothing here walks
+//   the games.
+template <class Rules>
+void PrintResults(const Player<Rules>* perPlayerData, int totalPlayerCount, const RoundResults* results)
+{
+	const RoundTotals* roundTotals = &results->totals;
+
+	Log("********* Player Results **********\n");
+	for (int i = 0; i < totalPlayerCount; i++)
+	{
+		Log("Player %d, Played %lld game(s), Won %lld, Lost %lld, Draw %lld, Strategy %s\n",
+			perPlayerData[i].id,
+			(long long)results->players[i].gamesPlayed,
+			(long long)results->players[i].winCount,
+			(long long)results->players[i].loseCount,
+			(long long)results->players[i].drawCount,
+			perPlayerData[i].strategy->Name()
+		);
+	}
+
+	Log("Total Players %d, Wins %lld, Losses %lld, Draws %lld\n\n\n", totalPlayerCount,
+		(long long)roundTotals->totalPlayerWins, (long long)roundTotals->totalPlayerLoses, (long long)(roundTotals->totalPlayerTies / 2));
+
+	int64_t totalGames = roundTotals->totalGamesWon + roundTotals->totalGamesTied;
+	Log("Total Games = %lld, %lld Games Won, %lld Games were a Draw\n\n\n",
+		(long long)totalGames, (long long)roundTotals->totalGamesWon, (long long)roundTotals->totalGamesTied);
+
+	// When everybody plays randomly on the classic board the outcome rates are known
+	//   exactly, so check the simulation against them.
+	bool allRandom = std::is_same<Rules, ClassicRules>::value;
+	for (int i = 0; i < totalPlayerCount; i++)
+	{
+		if (perPlayerData[i].strategy != &randomMoveStrategy<Rules>)
+			allRandom = false;
+	}
+
+	if (allRandom && totalGames > 0)
+	{
+		PositionInfo emptyBoard = gameTreeTable.Lookup(0, 0);
+		double observed[3] = {
+			(double)roundTotals->totalGamesWonByX,
+			(double)(roundTotals->totalGamesWon - roundTotals->totalGamesWonByX),
+			(double)roundTotals->totalGamesTied
+		};
+		double expected[3] = {
+			emptyBoard.xWinChance * totalGames,
+			emptyBoard.oWinChance * totalGames,
+			emptyBoard.drawChance * totalGames
+		};
+
+		double chiSquare = 0.0;
+		for (int i = 0; i < 3; i++)
+		{
+			double difference = observed[i] - expected[i];
+			chiSquare += difference * difference / expected[i];
+		}
+
+		// 13.82 is the 99.9th percentile of the chi-square distribution with 2 degrees of freedom
+		Log("********* Random Play vs Theory **********\n");
+		Log("X Wins %.3f%% (theory %.3f%%), O Wins %.3f%% (theory %.3f%%), Draws %.3f%% (theory %.3f%%)\n",
+			100.0 * observed[0] / totalGames, 100.0 * emptyBoard.xWinChance,
+			100.0 * observed[1] / totalGames, 100.0 * emptyBoard.oWinChance,
+			100.0 * observed[2] / totalGames, 100.0 * emptyBoard.drawChance);
+		Log("Chi-square %.2f, %s\n\n\n", chiSquare, (chiSquare < 13.82) ? "matches theory" : "DOES NOT match theory");
+	}
+}
+
+// Prints every player ordered by rating, with how far the rating moved this round
+template <class Rules>
+void PrintLeaderboard(const Player<Rules>* perPlayerData, int totalPlayerCount, const RoundResults* results, RatingTable* ratings)
+{
+	std::vector<int> order;
+	for (int i = 0; i < totalPlayerCount; i++)
+	{
+		order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+		{ return ratings->milliRatings[a].load() > ratings->milliRatings[b].load(); });
+
+	Log("********* Leaderboard **********\n");
+	for (int rank = 0; rank < totalPlayerCount; rank++)
+	{
+		int i = order[rank];
+		int64_t milliRating = ratings->milliRatings[i].load();
+		Log("%d. Player %d, Rating %.1f (%+.1f), Won %lld, Lost %lld, Draw %lld, Strategy %s\n",
+			rank + 1,
+			perPlayerData[i].id,
+			milliRating / 1000.0,
+			(milliRating - ratings->roundStartMilliRatings[i]) / 1000.0,
+			(long long)results->players[i].winCount,
+			(long long)results->players[i].loseCount,
+			(long long)results->players[i].drawCount,
+			perPlayerData[i].strategy->Name()
+		);
+		ratings->roundStartMilliRatings[i] = milliRating;
+	}
+	Log("\n\n");
+}
+
+// Lists the outcome of every game played in 'round'. This is a full pass over the games
+//   so it is skipped when running quiet.
+template <class Rules>
+void PrintGameResults(const Game<Rules>* perGameData, int64_t totalGameCount, int round)
+{
+	if (simulationSettings.quiet)
+		return;
+
+	Log("********* Game Results **********\n");
+	for (int64_t i = 0; i < totalGameCount; i++)
+	{
+		if (perGameData[i].ticket != round)
+			continue;
+
+		Log("Game %lld - 'X' player %d, 'O' player %d, game result %s\n",
+			(long long)perGameData[i].gameNumber,
+			perGameData[i].playerX,
+			perGameData[i].playerO,
+			((perGameData[i].currentGameState == GameState::Won) ? "Won" : "Draw")
+		);
+	}
+	Log("\n\n");
+}
+
+// Constructs and initializes games [firstGame, lastGame) in place
+template <class Rules>
+void ConstructGames(Game<Rules>* perGameData, int64_t firstGame, int64_t lastGame)
+{
+	for (int64_t i = firstGame; i < lastGame; i++)
+	{
+		new (&perGameData[i]) Game<Rules>();
+		ResetGame(&perGameData[i], -1, i);
+	}
+}
+
+// Prints how the arena is backed and how many TLB misses the player threads had
+void PrintMemoryStats(const SimulationArena* arena, const RoundTotals* roundTotals)
+{
+	int64_t totalGames = roundTotals->totalGamesWon + roundTotals->totalGamesTied;
+
+	Log("********* Memory **********\n");
+	Log("Arena %.1f MB backed by %s\n", arena->mappedBytes / (1024.0 * 1024.0), arena->backing);
+	if (roundTotals->tlbCountersUnavailable > 0)
+	{
+		Log("dTLB load misses could not be counted on %d player thread(s)\n", roundTotals->tlbCountersUnavailable);
+	}
+	Log("dTLB load misses %llu, %.2f per game\n\n\n",
+		(unsigned long long)roundTotals->dtlbLoadMisses,
+		(totalGames > 0) ? (double)roundTotals->dtlbLoadMisses / totalGames : 0.0);
+}
+
+// Picks the waiting policy settings left to be picked. With a core for every player thread
+//   the opponent is about to show up on another core and spinning catches it without a
+//   sleep and wake up. With more threads than cores the opponent may need this very core,
+//   so the player only yields it a couple of times before going to sleep.
+void ResolveWaitPolicy(int playerThreadCount)
+{
+	bool dedicatedCores = playerThreadCount <= (int)std::thread::hardware_concurrency();
+	if (simulationSettings.waitSpins < 0)
+		simulationSettings.waitSpins = dedicatedCores ? 4000 : 0;
+	if (simulationSettings.waitYields < 0)
+		simulationSettings.waitYields = dedicatedCores ? 16 : 2;
+}
+
+// Shows how the waits for an opponent ended in one round
+void PrintWaitStats(const RoundTotals* roundTotals)
+{
+	// Only the player that arrives first waits, the second one finds it there
+	int64_t waits = 0;
+	for (int phase = 0; phase < waitPhaseCount; phase++)
+	{
+		if (phase != WaitSecondArrival)
+			waits += roundTotals->opponentWaits[phase];
+	}
+	double percent = (waits > 0) ? 100.0 / waits : 0.0;
+
+	Log("********* Opponent Waits **********\n");
+	Log("Spinning up to %d time(s), then yielding up to %d time(s)\n", simulationSettings.waitSpins, simulationSettings.waitYields);
+	Log("%lld wait(s) by the player that arrived first: %.1f%% spun, %.1f%% yielded, %.1f%% slept\n", (long long)waits,
+		roundTotals->opponentWaits[WaitSpin] * percent, roundTotals->opponentWaits[WaitYield] * percent,
+		roundTotals->opponentWaits[WaitPark] * percent);
+	Log("%lld arrival(s) found the opponent already waiting\n\n\n", (long long)roundTotals->opponentWaits[WaitSecondArrival]);
+}
+
+// Shows how long a turn took to reach the opponent in one round, by how far apart the two
+//   players are pinned
+void PrintHandoffStats(const RoundTotals* roundTotals)
+{
+	static const char* distanceNames[handoffDistanceCount] = { "same core", "same cache", "across caches", "unpinned" };
+
+	Log("********* Turn Handoffs **********\n");
+	Log("Placement %s\n", PlacementPolicyName(simulationSettings.placement));
+	for (int distance = 0; distance < handoffDistanceCount; distance++)
+	{
+		int64_t handoffs = roundTotals->handoffs[distance];
+		if (handoffs == 0)
+			continue;
+
+		Log("%s - %lld handoff(s), %.2f us on average\n", distanceNames[distance], (long long)handoffs,
+			roundTotals->handoffNanoseconds[distance] / 1000.0 / handoffs);
+	}
+	Log("\n\n");
+}
+
+// Prints progress reports from a thread of its own, see ReportProgress
+struct ProgressReporter
+{
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool stopping;
+};
+
+// Body of the progress thread. Every progressInterval seconds it sums the finishedGames
+//   counters of the players and prints the games played so far, the speed over the last
+//   interval and overall, the fewest and most games any player finished in the interval
+//   and, when 'expectedGames' is known, how long the rest should take. The counters are
+//   only read, so the games never wait for the reporter.
+template <class Rules>
+void ReportProgress(ProgressReporter* reporter, const Player<Rules>* perPlayerData, int totalPlayerCount, int64_t expectedGames,
+	std::chrono::steady_clock::time_point deadline)
+{
+	std::vector<int64_t> previous(totalPlayerCount);
+	int64_t startGames = 0;
+	for (int i = 0; i < totalPlayerCount; i++)
+	{
+		previous[i] = perPlayerData[i].finishedGames.load(std::memory_order_relaxed);
+		startGames += previous[i];
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	auto last = start;
+	int64_t lastGames = 0;
+	auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<double>(simulationSettings.progressInterval));
+
+	std::unique_lock<std::mutex> reporterLock(reporter->mutex);
+	while (!reporter->condition.wait_for(reporterLock, interval, [&] { return reporter->stopping; }))
+	{
+		auto now = std::chrono::steady_clock::now();
+		int64_t finished = 0;
+		int64_t fewest = INT64_MAX;
+		int64_t most = 0;
+		for (int i = 0; i < totalPlayerCount; i++)
+		{
+			int64_t current = perPlayerData[i].finishedGames.load(std::memory_order_relaxed);
+			fewest = std::min(fewest, current - previous[i]);
+			most = std::max(most, current - previous[i]);
+			finished += current;
+			previous[i] = current;
+		}
+
+		// Both players count every game
+		int64_t games = (finished - startGames) / 2;
+		double elapsed = std::chrono::duration<double>(now - start).count();
+		double sinceLast = std::chrono::duration<double>(now - last).count();
+		double currentSpeed = (sinceLast > 0.0) ? (games - lastGames) / sinceLast : 0.0;
+		double averageSpeed = (elapsed > 0.0) ? games / elapsed : 0.0;
+		last = now;
+		lastGames = games;
+
+		char remaining[64] = "";
+		if (expectedGames > 0 && averageSpeed > 0.0)
+		{
+			double seconds = std::max(expectedGames - games, (int64_t)0) / averageSpeed;
+			if (simulationSettings.timeLimit > 0.0)
+				seconds = std::min(seconds, std::max(std::chrono::duration<double>(deadline - now).count(), 0.0));
+			snprintf(remaining, sizeof(remaining), ", %.1f%% done, %.0f s to go", 100.0 * games / expectedGames, seconds);
+		}
+
+		Log("Progress %.1f s: %lld game(s), %.0f games/s now, %.0f on average, %lld to %lld per player%s\n", elapsed, (long long)games,
+			currentSpeed, averageSpeed, (long long)fewest, (long long)most, remaining);
+	}
+}
+
+// Merges the position counts of every player, writes them to 'path' as CSV sorted by ply
+//   and then by visits, and shows the most played openings. Returns false when the file
+//   could not be written.
+template <class Rules>
+bool ExportPositionStats(const Player<Rules>* perPlayerData, int totalPlayerCount, const std::string& path)
+{
+	// Big enough for everything the players saw, within reason
+	size_t seen = 0;
+	for (int i = 0; i < totalPlayerCount; i++)
+	{
+		seen += perPlayerData[i].positionStats.used;
+	}
+	size_t capacity = PositionStats::playerCapacity;
+	while (capacity < seen * 2 && capacity < ((size_t)1 << 20))
+	{
+		capacity *= 2;
+	}
+
+	PositionStats merged;
+	merged.Init(capacity);
+	for (int i = 0; i < totalPlayerCount; i++)
+	{
+		merged.Merge(perPlayerData[i].positionStats);
+	}
+
+	std::vector<PositionCount> positions;
+	for (const PositionCount& entry : merged.entries)
+	{
+		if (entry.visits > 0)
+			positions.push_back(entry);
+	}
+	std::sort(positions.begin(), positions.end(), [](const PositionCount& a, const PositionCount& b)
+		{ return (a.ply != b.ply) ? a.ply < b.ply : a.visits > b.visits; });
+
+	// Classic boards are written out cell by cell, row by row, everything else by its hash
+	auto describe = [](const PositionCount& entry)
+	{
+		char text[24];
+		if constexpr (std::is_same<Rules, ClassicRules>::value)
+		{
+			for (int cell = 0; cell < 9; cell++)
+			{
+				text[cell] = (entry.key & (1ull << (cell + 9))) ? 'X' : (entry.key & (1ull << cell)) ? 'O' : '.';
+			}
+			text[9] = '\0';
+		}
+		else
+		{
+			snprintf(text, sizeof(text), "%016llx", (unsigned long long)entry.key);
+		}
+		return std::string(text);
+	};
+
+	FILE* file = fopen(path.c_str(), "w");
+	bool written = file != nullptr && fprintf(file, "ply,position,visits,x_wins,o_wins,draws\n") > 0;
+	for (size_t i = 0; written && i < positions.size(); i++)
+	{
+		const PositionCount& entry = positions[i];
+		written = fprintf(file, "%lld,%s,%lld,%lld,%lld,%lld\n", (long long)entry.ply, describe(entry).c_str(),
+			(long long)entry.visits, (long long)entry.xWins, (long long)entry.oWins, (long long)entry.draws) > 0;
+	}
+	if (file != nullptr)
+		written = (fclose(file) == 0) && written;
+
+	Log("********* Openings **********\n");
+	int shown = 0;
+	for (size_t i = 0; i < positions.size() && shown < 5; i++)
+	{
+		const PositionCount& entry = positions[i];
+		if (entry.ply != 1)
+			continue;
+
+		Log("%s - %lld game(s), 'X' won %.1f%%, 'O' won %.1f%%, %.1f%% were a Draw\n", describe(entry).c_str(), (long long)entry.visits,
+			100.0 * entry.xWins / entry.visits, 100.0 * entry.oWins / entry.visits, 100.0 * entry.draws / entry.visits);
+		shown++;
+	}
+	Log("%zu position(s) within %d move(s) counted, %lld visit(s) did not fit, written to %s\n",
+		positions.size(), simulationSettings.positionStatsDepth, (long long)merged.droppedVisits, path.c_str());
+	return written;
+}
+
+// Returns how many entries perGameData needs for 'totalGameCount' games. When streaming
+//   one entry per table is enough, so memory doesn't grow with the game count.
+int64_t GameSlotCount(int64_t totalGameCount, int playerCount, bool streaming)
+{
+	if (streaming && totalGameCount > playerCount / 2)
+		return playerCount / 2;
+	return totalGameCount;
+}
+
+// Constructs and initializes every game. Constructing is the first write to the arena
+//   pages, so with parallelFirstTouch it is split across one thread per CPU, each pinned
+//   before it writes, and the pages are spread evenly over the memory nodes instead of
+//   all landing next to main. With the games split between nodes, each node's share is
+//   constructed by a thread pinned to that node.
+template <class Rules>
+void ConstructAllGames(Game<Rules>* perGameData, int64_t gameSlotCount)
+{
+	if (numaLayout.SplitsGames())
+	{
+		std::vector<std::thread> nodeThreads;
+		for (int node = 0; node < (int)numaLayout.nodes.size(); node++)
+		{
+			int64_t firstGame = numaLayout.FirstGame(node, gameSlotCount);
+			int64_t lastGame = numaLayout.FirstGame(node + 1, gameSlotCount);
+			int cpu = numaLayout.nodeCpus[node];
+			nodeThreads.emplace_back([=]
+				{
+					PinCurrentThread(cpu);
+					ConstructGames<Rules>(perGameData, firstGame, lastGame);
+				});
+		}
+		for (std::thread& thread : nodeThreads)
+		{
+			thread.join();
+		}
+		return;
+	}
+
+	// Without a CPU list the threads are left where the scheduler puts them
+	std::vector<CpuPlace> cpuPlaces = simulationSettings.parallelFirstTouch ? ListCpuPlaces() : std::vector<CpuPlace>();
+	int constructionThreadCount = !cpuPlaces.empty() ? (int)cpuPlaces.size() :
+		simulationSettings.parallelFirstTouch ? (int)std::thread::hardware_concurrency() : 1;
+	if (constructionThreadCount < 1)
+		constructionThreadCount = 1;
+
+	std::atomic<int> unpinnedCount(0);
+	std::vector<std::thread> constructionThreads;
+	for (int t = 0; t < constructionThreadCount; t++)
+	{
+		int64_t firstGame = gameSlotCount * t / constructionThreadCount;
+		int64_t lastGame = gameSlotCount * (t + 1) / constructionThreadCount;
+		int cpu = !cpuPlaces.empty() ? cpuPlaces[t].cpu : -1;
+		constructionThreads.emplace_back([=, &unpinnedCount]
+			{
+				if (cpu >= 0 && !PinCurrentThread(cpu))
+					unpinnedCount++;
+				ConstructGames<Rules>(perGameData, firstGame, lastGame);
+			});
+	}
+	for (std::thread& thread : constructionThreads)
+	{
+		thread.join();
+	}
+	if (unpinnedCount > 0)
+	{
+		Log("%d construction thread(s) could not be pinned to their CPU, their games may be on another node\n", unpinnedCount.load());
+	}
+}
+
+// Starts a thread for every player that plays rounds [firstRound, lastRound), and fires
+//   the starting gun once all of them are ready
+template <class Rules>
+void StartPlayerThreads(Player<Rules>* perPlayerData, PlayerPool* poolOfPlayers, int totalPlayerCount, int firstRound, int lastRound)
+{
+	poolOfPlayers->gunFlag = false;
+	int unpinnedCount = 0;
+	for (int i = 0; i < totalPlayerCount; i++) {
+		std::thread playerThread(PlayerThreadEntrypoint<Rules>, &perPlayerData[i], firstRound, lastRound);
+		if (perPlayerData[i].cpu >= 0 && !PinThread(playerThread, perPlayerData[i].cpu))
+			unpinnedCount++;
+		playerThread.detach();
+	}
+	if (unpinnedCount > 0)
+	{
+		Log("%d player thread(s) could not be pinned to their CPU\n", unpinnedCount);
+	}
+
+	// Wait for all players to be ready 
+	std::unique_lock<std::mutex> totalPlayerCountUniqueLock(poolOfPlayers->totalPlayersMutex);
+	poolOfPlayers->playerCondition.wait(totalPlayerCountUniqueLock, [&] {return poolOfPlayers->totalPlayerCount == totalPlayerCount; });
+
+	totalPlayerCountUniqueLock.unlock();
+
+	// Under the mutex the players wait on, so none of them checks the flag and then misses the notification
+	poolOfPlayers->playersIncrementMutex.lock();
+	poolOfPlayers->gunFlag = true;
+	poolOfPlayers->playersIncrementMutex.unlock();
+
+	// Notify all waiting threads that they can start playing.
+	poolOfPlayers->playerIncrementCondition.notify_all();
+	poolOfPlayers->playerDecrementCondition.notify_all();
+}
+
+// Waits for every player to finish 'round'. Players may already be playing the next one.
+//   Checks every now and then whether the run should stop early, and stops the players
+//   when it should.
+template <class Rules>
+void WaitForRound(Player<Rules>* perPlayerData, PlayerPool* poolOfPlayers, int round, int totalPlayerCount)
+{
+	std::unique_lock<std::mutex> totalPlayerCountUniqueLock(poolOfPlayers->totalPlayersMutex);
+	RoundResults* results = &poolOfPlayers->roundResults[round];
+	while (!poolOfPlayers->playerCondition.wait_for(totalPlayerCountUniqueLock, std::chrono::milliseconds(20),
+		[&] {return results->playersFinished == totalPlayerCount; }))
+	{
+		if (!poolOfPlayers->stopRequested && RunShouldStop(poolOfPlayers))
+			StopPlayers(perPlayerData, poolOfPlayers, totalPlayerCount);
+	}
+}
+
+// Waits for all detached player threads to complete
+void WaitForPlayerThreads(PlayerPool* poolOfPlayers)
+{
+	std::unique_lock<std::mutex> totalPlayerCountUniqueLock(poolOfPlayers->totalPlayersMutex);
+	poolOfPlayers->playerCondition.wait(totalPlayerCountUniqueLock, [&] {return poolOfPlayers->totalPlayerCount == 0; });
+}
+
+// Plays 'gameCount' games as a round of their own on freshly made games, with the player
+//   random number generators seeded from 'seed'. This is how worker processes play their
+//   share of a round, the results end up in the first entry of roundResults and the
+//   outcome of every game in 'outcomes' when given.
+template <class Rules>
+bool PlayGameBatch(Player<Rules>* perPlayerData, PlayerPool* poolOfPlayers, GamePool<Rules>* poolOfGames,
+	int totalPlayerCount, int64_t gameCount, uint64_t seed, GameOutcome* outcomes)
+{
+	int64_t gameSlotCount = GameSlotCount(gameCount, totalPlayerCount, simulationSettings.streamGames);
+
+	// The players already exist, only the games are new
+	SimulationArena gameArena;
+	const size_t cacheLineSize = 64;
+	if (!ArenaReserve(&gameArena, sizeof(Game<Rules>) * (size_t)gameSlotCount + cacheLineSize, simulationSettings.hugePages))
+		return false;
+	if (simulationSettings.numa == NumaMode::Interleave)
+		ArenaInterleave(&gameArena, &numaLayout);
+
+	Game<Rules>* perGameData = (Game<Rules>*)ArenaAllocate(&gameArena, sizeof(Game<Rules>) * (size_t)gameSlotCount, cacheLineSize);
+	poolOfGames->perGameData = perGameData;
+	poolOfGames->totalGameCount = gameCount;
+	poolOfGames->gameSlotCount = gameSlotCount;
+	ConstructAllGames(perGameData, gameSlotCount);
+	BuildSchedule(poolOfGames->schedule, simulationSettings.scheduleType, totalPlayerCount, gameCount, simulationSettings.streamGames,
+		MixSeed(seed, (uint64_t)totalPlayerCount));
+	poolOfGames->schedule->outcomes = outcomes;
+
+	for (int i = 0; i < totalPlayerCount; i++)
+	{
+		perPlayerData[i].myRand.Init(0, INT_MAX, MixSeed(seed, i));
+	}
+
+	// The games are brand new, so to them this is the first round
+	poolOfPlayers->roundResults.resize(1);
+	RoundResults& results = poolOfPlayers->roundResults[0];
+	memset(&results.totals, 0, sizeof(results.totals));
+	results.playersFinished = 0;
+	results.players.assign(totalPlayerCount, PlayerRoundResult());
+	StartPlayerThreads(perPlayerData, poolOfPlayers, totalPlayerCount, 0, 1);
+	WaitForPlayerThreads(poolOfPlayers);
+
+	for (int64_t i = 0; i < gameSlotCount; i++)
+	{
+		perGameData[i].~Game<Rules>();
+	}
+	ArenaRelease(&gameArena);
+	return true;
+}
+
+// Body of worker process 'shard' of a sharded run. Plays the worker's share of the games
+//   of 'round', then leaves the results in 'region' and the outcome of each of its games in
+//   its own part of 'roundOutcomes' when given. Returns the worker's exit code.
+template <class Rules>
+int PlayShard(Player<Rules>* perPlayerData, PlayerPool* poolOfPlayers, GamePool<Rules>* poolOfGames,
+	const ShardRegion* region, int shard, int totalPlayerCount, int64_t totalGameCount, GameOutcome* roundOutcomes)
+{
+	int64_t firstGame = totalGameCount * shard / region->shardCount;
+	int64_t shardGameCount = totalGameCount * (shard + 1) / region->shardCount - firstGame;
+
+	// Every worker forked off the same random states, so draw a fresh seed or the shards
+	//   play the same games
+	std::random_device seedDevice;
+	uint64_t seed = ((uint64_t)seedDevice() << 32) | seedDevice();
+	if (!PlayGameBatch(perPlayerData, poolOfPlayers, poolOfGames, totalPlayerCount, shardGameCount, seed,
+		roundOutcomes ? roundOutcomes + firstGame : nullptr))
+		return 1;
+
+	const RoundResults* results = &poolOfPlayers->roundResults[0];
+	*ShardTotals(region, shard) = results->totals;
+	memcpy(ShardPlayers(region, shard), results->players.data(), sizeof(PlayerRoundResult) * totalPlayerCount);
+	return 0;
+}
+
+// Splits the games of 'round' between one forked worker process per shard of 'region' and
+//   merges what the workers report into the round's results. The workers store the game
+//   outcomes in 'roundOutcomes' when given. Returns false when a worker could not be
+//   started or failed.
+template <class Rules>
+bool PlayShardedRound(Player<Rules>* perPlayerData, PlayerPool* poolOfPlayers, GamePool<Rules>* poolOfGames,
+	const ShardRegion* region, int round, int totalPlayerCount, int64_t totalGameCount, GameOutcome* roundOutcomes)
+{
+#if defined(__linux__)
+	memset(region->base, 0, region->shardStride * region->shardCount);
+
+	// Anything still buffered would be printed again by every worker
+	fflush(stdout);
+
+	std::vector<pid_t> workers;
+	bool succeeded = true;
+	for (int shard = 0; shard < region->shardCount; shard++)
+	{
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			int exitCode = PlayShard(perPlayerData, poolOfPlayers, poolOfGames, region, shard, totalPlayerCount, totalGameCount, roundOutcomes);
+			fflush(stdout);
+			_exit(exitCode);
+		}
+		if (pid == -1)
+		{
+			succeeded = false;
+			break;
+		}
+		workers.push_back(pid);
+	}
+
+	for (pid_t pid : workers)
+	{
+		int status = 0;
+		if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			succeeded = false;
+	}
+
+	// Merge the shards as if one process had played every game
+	RoundResults* results = &poolOfPlayers->roundResults[round];
+	for (int shard = 0; shard < region->shardCount; shard++)
+	{
+		MergeResults(results, ShardTotals(region, shard), ShardPlayers(region, shard), totalPlayerCount);
+	}
+	results->playersFinished = totalPlayerCount;
+	return succeeded;
+#else
+	return false;
+#endif
+}
+
+// Body of a batch worker. Connects to the coordinator at 'path' and plays every batch it
+//   is handed until it is told to shut down. Returns the worker's exit code.
+template <class Rules>
+int RunBatchWorker(const std::string& path, Player<Rules>* perPlayerData, PlayerPool* poolOfPlayers, GamePool<Rules>* poolOfGames,
+	int totalPlayerCount)
+{
+	int fd = OpenBatchSocket(path, false);
+	if (fd == -1)
+	{
+		std::cerr << "Error: Could not connect to the coordinator at '" << path << "'." << std::endl;
+		return 1;
+	}
+
+	std::vector<char> reply(sizeof(BatchResultMessage) + sizeof(PlayerRoundResult) * totalPlayerCount);
+	std::vector<GameOutcome> outcomes;
+	int exitCode = 0;
+
+	BatchMessage batch;
+	while (ReceiveAll(fd, &batch, sizeof(batch)) && batch.gameCount > 0)
+	{
+		if (batch.playerCount != totalPlayerCount)
+		{
+			std::cerr << "Error: The coordinator runs " << batch.playerCount << " players, this worker " << totalPlayerCount << "." << std::endl;
+			exitCode = 1;
+			break;
+		}
+
+		outcomes.resize((size_t)batch.gameCount);
+		auto batchStart = std::chrono::steady_clock::now();
+		if (!PlayGameBatch(perPlayerData, poolOfPlayers, poolOfGames, totalPlayerCount, batch.gameCount, batch.seed, outcomes.data()))
+		{
+			exitCode = 1;
+			break;
+		}
+
+		const RoundResults* results = &poolOfPlayers->roundResults[0];
+		BatchResultMessage* message = (BatchResultMessage*)reply.data();
+		message->firstGame = batch.firstGame;
+		message->gameCount = batch.gameCount;
+		message->elapsedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - batchStart).count();
+		message->totals = results->totals;
+		memcpy(reply.data() + sizeof(BatchResultMessage), results->players.data(), sizeof(PlayerRoundResult) * totalPlayerCount);
+
+		if (!SendAll(fd, reply.data(), reply.size()) || !SendAll(fd, outcomes.data(), sizeof(GameOutcome) * outcomes.size()))
+			break;
+	}
+
+#if defined(__linux__)
+	close(fd);
+#endif
+	return exitCode;
+}
+
+// Plays 'round' by handing out its games in batches to the workers of 'coordinator'. New
+//   workers are picked up as they connect, and the games of a worker that drops out are
+//   handed to another one. The outcomes the workers send back are copied to 'roundOutcomes'
+//   when given. Returns false when there are no workers left to play the round.
+template <class Rules>
+bool PlayCoordinatedRound(BatchCoordinator* coordinator, PlayerPool* poolOfPlayers, int round, int totalPlayerCount, int64_t totalGameCount,
+	GameOutcome* roundOutcomes)
+{
+#if defined(__linux__)
+	RoundResults* results = &poolOfPlayers->roundResults[round];
+	const int64_t minBatchGames = (totalPlayerCount / 2 > 0) ? totalPlayerCount / 2 : 1;
+
+	// Games not handed out yet: everything past the cursor plus batches of lost workers
+	int64_t nextGame = 0;
+	std::vector<std::pair<int64_t, int64_t>> returnedBatches;
+	int64_t gamesLeft = totalGameCount;
+
+	std::vector<char> reply(sizeof(BatchResultMessage) + sizeof(PlayerRoundResult) * totalPlayerCount);
+	std::vector<GameOutcome> outcomes;
+
+	while (gamesLeft > 0)
+	{
+		// Give every idle worker the next batch, sized to its throughput. Near the end the
+		//   batches shrink so the workers finish at about the same time.
+		for (BatchWorker& worker : coordinator->workers)
+		{
+			if (worker.gameCount > 0)
+				continue;
+
+			int64_t firstGame;
+			int64_t gameCount;
+			if (!returnedBatches.empty())
+			{
+				firstGame = returnedBatches.back().first;
+				gameCount = returnedBatches.back().second;
+				returnedBatches.pop_back();
+			}
+			else if (nextGame < totalGameCount)
+			{
+				int64_t remaining = totalGameCount - nextGame;
+				int64_t fairShare = remaining / (int64_t)coordinator->workers.size();
+				gameCount = std::min(worker.batchGames, std::max(fairShare, minBatchGames));
+				gameCount = std::min(gameCount, remaining);
+				firstGame = nextGame;
+				nextGame += gameCount;
+			}
+			else
+			{
+				break;
+			}
+
+			if (!SendBatch(coordinator, &worker, round, firstGame, gameCount, totalPlayerCount))
+			{
+				// Picked up as a lost worker below
+				worker.gameCount = 0;
+				returnedBatches.emplace_back(firstGame, gameCount);
+				close(worker.fd);
+				worker.fd = -1;
+			}
+		}
+		coordinator->workers.erase(std::remove_if(coordinator->workers.begin(), coordinator->workers.end(),
+			[](const BatchWorker& worker) { return worker.fd == -1; }), coordinator->workers.end());
+
+		// Without any outside workers expected, the round is lost once the local ones are gone
+		for (size_t i = 0; i < coordinator->localWorkerPids.size();)
+		{
+			if (waitpid(coordinator->localWorkerPids[i], nullptr, WNOHANG) == coordinator->localWorkerPids[i])
+				coordinator->localWorkerPids.erase(coordinator->localWorkerPids.begin() + i);
+			else
+				i++;
+		}
+		if (coordinator->workers.empty() && coordinator->localWorkerPids.empty() && simulationSettings.batchWorkerCount > 0)
+			return false;
+
+		std::vector<pollfd> pollFds;
+		pollFds.push_back({ coordinator->listenFd, POLLIN, 0 });
+		for (const BatchWorker& worker : coordinator->workers)
+		{
+			pollFds.push_back({ worker.fd, POLLIN, 0 });
+		}
+		if (poll(pollFds.data(), pollFds.size(), 1000) <= 0)
+			continue;
+
+		// Results first, then new workers, so the indexes still match the workers
+		for (size_t i = 1; i < pollFds.size(); i++)
+		{
+			if ((pollFds[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+				continue;
+
+			BatchWorker& worker = coordinator->workers[i - 1];
+			BatchResultMessage* message = (BatchResultMessage*)reply.data();
+			bool received = ReceiveAll(worker.fd, reply.data(), reply.size()) && message->gameCount == worker.gameCount;
+			if (received)
+			{
+				outcomes.resize((size_t)message->gameCount);
+				received = ReceiveAll(worker.fd, outcomes.data(), sizeof(GameOutcome) * outcomes.size());
+			}
+			if (!received)
+			{
+				if (worker.gameCount > 0)
+					returnedBatches.emplace_back(worker.firstGame, worker.gameCount);
+				close(worker.fd);
+				worker.fd = -1;
+				continue;
+			}
+
+			const PlayerRoundResult* players = (const PlayerRoundResult*)(reply.data() + sizeof(BatchResultMessage));
+			MergeResults(results, &message->totals, players, totalPlayerCount);
+
+			// Rate the games here, one at a time, as if they had been played in this process
+			for (const GameOutcome& outcome : outcomes)
+			{
+				UpdateRatings(poolOfPlayers->ratings, outcome.playerX, outcome.playerO, (PlayerType)outcome.winner);
+			}
+			if (roundOutcomes)
+				memcpy(roundOutcomes + worker.firstGame, outcomes.data(), sizeof(GameOutcome) * outcomes.size());
+			gamesLeft -= message->gameCount;
+
+			// Aim the next batch at the target time from the throughput just measured
+			double seconds = message->elapsedMicroseconds / 1e6;
+			double gamesPerSecond = message->gameCount / ((seconds > 1e-6) ? seconds : 1e-6);
+			worker.batchGames = std::max(minBatchGames, std::min(maxBatchGames, (int64_t)(gamesPerSecond * batchTargetSeconds)));
+			worker.gameCount = 0;
+		}
+		coordinator->workers.erase(std::remove_if(coordinator->workers.begin(), coordinator->workers.end(),
+			[](const BatchWorker& worker) { return worker.fd == -1; }), coordinator->workers.end());
+
+		if (pollFds[0].revents & POLLIN)
+		{
+			int fd = accept4(coordinator->listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+			if (fd != -1)
+				coordinator->workers.push_back({ fd, 0, 0, initialBatchGames });
+		}
+	}
+
+	results->playersFinished = totalPlayerCount;
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Plays the round 'checkpoint' points at in chunks of checkpointGames games and saves a
+//   checkpoint after every chunk. A chunk is rated game by game in order once it is over,
+//   so together with the chunk seeds a resumed run ends up exactly where an uninterrupted
+//   one would. The outcomes go to 'results' when given, synced before every checkpoint.
+//   Returns false when a chunk could not be played or saved.
+template <class Rules>
+bool PlayCheckpointedRound(Player<Rules>* perPlayerData, PlayerPool* poolOfPlayers, GamePool<Rules>* poolOfGames,
+	CheckpointHeader* checkpoint, int totalPlayerCount, const ResultsFile* resultsFile)
+{
+	int round = checkpoint->round;
+	RatingTable* ratings = poolOfPlayers->ratings;
+
+	// The player threads rate into a scratch table, whose updates land in whatever order
+	//   the games happen to finish
+	RatingTable scratchRatings;
+	InitRatings(&scratchRatings, totalPlayerCount, ratings->kFactor, nullptr);
+
+	// PlayGameBatch keeps its results in the first entry, park the rounds meanwhile
+	std::vector<RoundResults> allRounds;
+	allRounds.swap(poolOfPlayers->roundResults);
+	RoundResults* results = &allRounds[round];
+	std::vector<GameOutcome> outcomes;
+	bool succeeded = true;
+
+	while (checkpoint->nextGame < checkpoint->totalGameCount)
+	{
+		// Stop between chunks, the checkpoint of the last one lets the round be resumed
+		if (RunShouldStop(poolOfPlayers))
+		{
+			poolOfPlayers->stopRequested = true;
+			break;
+		}
+
+		int64_t gameCount = std::min(checkpoint->checkpointGames, checkpoint->totalGameCount - checkpoint->nextGame);
+		uint64_t seed = MixSeed(MixSeed(checkpoint->runSeed, (uint64_t)round), (uint64_t)checkpoint->nextGame);
+		GameOutcome* chunkOutcomes;
+		if (resultsFile)
+		{
+			chunkOutcomes = ResultsRecords(resultsFile, round) + checkpoint->nextGame;
+		}
+		else
+		{
+			outcomes.resize((size_t)gameCount);
+			chunkOutcomes = outcomes.data();
+		}
+
+		poolOfPlayers->ratings = &scratchRatings;
+		succeeded = PlayGameBatch(perPlayerData, poolOfPlayers, poolOfGames, totalPlayerCount, gameCount, seed, chunkOutcomes);
+		poolOfPlayers->ratings = ratings;
+		if (!succeeded)
+			break;
+
+		const RoundResults* chunk = &poolOfPlayers->roundResults[0];
+		MergeResults(results, &chunk->totals, chunk->players.data(), totalPlayerCount);
+		for (int64_t i = 0; i < gameCount; i++)
+		{
+			UpdateRatings(ratings, chunkOutcomes[i].playerX, chunkOutcomes[i].playerO, (PlayerType)chunkOutcomes[i].winner);
+		}
+
+		checkpoint->nextGame += gameCount;
+		checkpoint->totals = results->totals;
+		if (resultsFile && !ResultsFileSync(resultsFile))
+		{
+			std::cerr << "Error: Could not write the results to '" << simulationSettings.resultsPath << "'." << std::endl;
+			succeeded = false;
+			break;
+		}
+		if (!SaveCheckpoint(simulationSettings.checkpointPath, checkpoint, results, ratings))
+		{
+			std::cerr << "Error: Could not save the checkpoint to '" << simulationSettings.checkpointPath << "'." << std::endl;
+			succeeded = false;
+			break;
+		}
+	}
+
+	results->playersFinished = totalPlayerCount;
+	poolOfPlayers->roundResults.swap(allRounds);
+	return succeeded;
+}
+
+// Runs every round of the simulation on the board described by 'Rules'. Returns the
+//   process exit code.
+template <class Rules>
+int RunSimulation(const char* programName, int totalPlayerCount, int64_t totalGameCount)
+{
+	// An array of player specific data with exactly one entry for each player.
+	Player<Rules>* perPlayerData;
+	// Contains all data needed to keep track of players.
+	PlayerPool poolOfPlayers;
+	// An array of game specific data with exactly one entry for each game.
+	Game<Rules>* perGameData;
+	// Contains all of the games. 
+	GamePool<Rules> poolOfGames;
+	// Pairings of every game in the round.
+	TournamentSchedule schedule;
+	schedule.outcomes = nullptr;
+	// Rating of every player, kept across rounds.
+	RatingTable ratings;
+	// Memory holding the players and games.
+	SimulationArena arena;
+
+	// Split the strategy list, players are handed the strategies in turn
+	std::vector<MoveStrategy<Rules>*> playerStrategies;
+	std::string strategyNames = simulationSettings.strategies.empty() ? "random" : simulationSettings.strategies;
+	size_t nameStart = 0;
+	while (nameStart <= strategyNames.size())
+	{
+		size_t nameEnd = strategyNames.find(',', nameStart);
+		if (nameEnd == std::string::npos)
+			nameEnd = strategyNames.size();
+
+		std::string name = strategyNames.substr(nameStart, nameEnd - nameStart);
+		MoveStrategy<Rules>* strategy = FindMoveStrategy<Rules>(name);
+		if (strategy == nullptr)
+		{
+			std::cerr << "Error: Unknown strategy '" << name << "'." << std::endl;
+			return 1;
+		}
+		if constexpr (std::is_same<Rules, ClassicRules>::value)
+		{
+			if (strategy == &perfectMoveStrategy)
+			{
+				// Solve the game tree once up front so perfect moves are a table lookup
+				minimaxSolver.Solve();
+			}
+		}
+
+		playerStrategies.push_back(strategy);
+		nameStart = nameEnd + 1;
+	}
+
+	// Streaming only keeps the games of one schedule round, which needs pairings that can be
+	//   worked out from the round number alone
+	bool streaming = simulationSettings.streamGames;
+	if (streaming && simulationSettings.scheduleType != ScheduleType::RoundRobin)
+	{
+		std::cerr << "Error: Streaming games requires the round-robin schedule." << std::endl;
+		return 1;
+	}
+
+	Log("%s starting %d player(s) for %lld game(s) on a %dx%d board, %d in a row wins\n",
+		programName, totalPlayerCount, (long long)totalGameCount, Rules::size, Rules::size, Rules::winLength);
+	ResolveWaitPolicy(totalPlayerCount);
+
+	// Sharded runs fork worker processes that each play a share of every round. The
+	//   launcher itself plays no games, so it doesn't need any.
+	bool sharded = simulationSettings.processCount > 1;
+	ShardRegion shardRegion;
+	if (sharded && !ShardRegionCreate(&shardRegion, simulationSettings.processCount, totalPlayerCount))
+	{
+		std::cerr << "Error: Could not set up shared memory for " << simulationSettings.processCount << " worker processes." << std::endl;
+		return 1;
+	}
+
+	// Same for a batch coordinator, its workers play the games. A batch worker makes its games
+	//   per batch.
+	bool coordinated = !simulationSettings.socketPath.empty() && !simulationSettings.batchWorker;
+
+	// Checkpointed runs play in chunks with games made per chunk, see PlayCheckpointedRound
+	bool checkpointing = !simulationSettings.checkpointPath.empty() && !simulationSettings.batchWorker;
+	if (checkpointing && (sharded || coordinated))
+	{
+		std::cerr << "Error: Checkpoints need the games to be played in this process." << std::endl;
+		return 1;
+	}
+	bool playsLocally = !sharded && !coordinated && !checkpointing && !simulationSettings.batchWorker;
+
+	// Position counts are kept by the player threads of this process, see PositionStats
+	bool countingPositions = !simulationSettings.positionStatsPath.empty() && !simulationSettings.batchWorker;
+	if (countingPositions && (sharded || coordinated))
+	{
+		std::cerr << "Error: Position statistics need the games to be played in this process." << std::endl;
+		return 1;
+	}
+
+	// Only threads of this process are pinned, worker processes would all pick the same CPUs
+	if (simulationSettings.placement != PlacementPolicy::None && (sharded || coordinated))
+	{
+		std::cerr << "Error: Thread placement needs the games to be played in this process." << std::endl;
+		return 1;
+	}
+	std::vector<CpuPlace> cpuPlaces = PlacementOrder(simulationSettings.placement);
+	if (!cpuPlaces.empty())
+	{
+		Log("Pinning the player threads %s over %zu CPU(s)\n", PlacementPolicyName(simulationSettings.placement), cpuPlaces.size());
+	}
+	else if (simulationSettings.placement != PlacementPolicy::None)
+	{
+		Log("The CPUs could not be listed, the player threads are not pinned\n");
+	}
+
+	// Worker processes play their share to the end, only this process can stop early
+	if (simulationSettings.timeLimit > 0.0 && (sharded || coordinated))
+	{
+		std::cerr << "Error: A time limit needs the games to be played in this process." << std::endl;
+		return 1;
+	}
+	if (simulationSettings.progressInterval > 0.0 && (sharded || coordinated))
+	{
+		std::cerr << "Error: Progress reports need the games to be played in this process." << std::endl;
+		return 1;
+	}
+
+	// A node only keeps the games its own players play, which needs the players pinned and
+	//   the games handed out as they come instead of paired up front
+	if (simulationSettings.numa != NumaMode::Off && (sharded || coordinated))
+	{
+		std::cerr << "Error: NUMA placement needs the games to be played in this process." << std::endl;
+		return 1;
+	}
+	if (simulationSettings.numa == NumaMode::Local)
+	{
+		if (simulationSettings.scheduleType != ScheduleType::Queue)
+		{
+			std::cerr << "Error: Keeping the games on their players' NUMA node needs --schedule queue." << std::endl;
+			return 1;
+		}
+		if (cpuPlaces.empty())
+		{
+			std::cerr << "Error: Keeping the games on their players' NUMA node needs the player threads pinned, see --placement." << std::endl;
+			return 1;
+		}
+		if (BuildNumaLayout(&numaLayout, cpuPlaces, totalPlayerCount))
+			Log("Splitting the games between %zu NUMA node(s)\n", numaLayout.nodes.size());
+		else
+			Log("A NUMA node would have a single player, the games are not split\n");
+	}
+	else if (simulationSettings.numa == NumaMode::Interleave)
+	{
+		for (const CpuPlace& place : ListCpuPlaces())
+		{
+			numaLayout.nodes.push_back(place.node);
+		}
+		std::sort(numaLayout.nodes.begin(), numaLayout.nodes.end());
+		numaLayout.nodes.erase(std::unique(numaLayout.nodes.begin(), numaLayout.nodes.end()), numaLayout.nodes.end());
+	}
+
+	int64_t gameSlotCount = playsLocally ? GameSlotCount(totalGameCount, totalPlayerCount, streaming) : 0;
+
+	// Allocate the players and games out of one arena
+	const size_t cacheLineSize = 64;
+	size_t arenaBytes = sizeof(Player<Rules>) * totalPlayerCount + sizeof(Game<Rules>) * (size_t)gameSlotCount + 2 * cacheLineSize;
+	if (!ArenaReserve(&arena, arenaBytes, simulationSettings.hugePages))
+	{
+		std::cerr << "Error: Could not allocate " << arenaBytes << " bytes for the simulation." << std::endl;
+		return 1;
+	}
+	if (simulationSettings.numa == NumaMode::Interleave)
+	{
+		if (ArenaInterleave(&arena, &numaLayout))
+			Log("Arena interleaved over %zu NUMA node(s)\n", numaLayout.nodes.size());
+		else
+			Log("The arena could not be interleaved, its pages stay where they are first touched\n");
+	}
+
+	perPlayerData = (Player<Rules>*)ArenaAllocate(&arena, sizeof(Player<Rules>) * totalPlayerCount, cacheLineSize);
+	perGameData = (Game<Rules>*)ArenaAllocate(&arena, sizeof(Game<Rules>) * (size_t)gameSlotCount, cacheLineSize);
+	Log("Arena of %.1f MB backed by %s\n", arena.mappedBytes / (1024.0 * 1024.0), arena.backing);
+
+	// Initialize pool of games
+	poolOfGames.perGameData = perGameData;
+	poolOfGames.totalGameCount = totalGameCount;
+	poolOfGames.gameSlotCount = gameSlotCount;
+	poolOfGames.schedule = &schedule;
+
+	// Initialize your data in the pool of players
+	poolOfPlayers.totalPlayerCount = 0;
+	poolOfPlayers.gunFlag = false;
+	poolOfPlayers.stopRequested = false;
+	poolOfPlayers.stopPosition = -1;
+	poolOfPlayers.ratings = &ratings;
+	InitRatings(&ratings, totalPlayerCount, simulationSettings.eloKFactor, sharded ? ShardRatings(&shardRegion) : nullptr);
+
+	CheckpointHeader checkpoint;
+	RoundResults resumedResults;
+	bool resumedRoundPending = false;
+	if (checkpointing)
+	{
+		memset(&checkpoint, 0, sizeof(checkpoint));
+		if (simulationSettings.resume)
+		{
+			if (!LoadCheckpoint(simulationSettings.checkpointPath, &checkpoint, &resumedResults, &ratings, totalPlayerCount, totalGameCount))
+			{
+				std::cerr << "Error: Could not resume from '" << simulationSettings.checkpointPath << "', it is missing or belongs to a different run." << std::endl;
+				return 1;
+			}
+			// The rest of the run keeps the seed it started with, a new one would not match the results file
+			simulationSettings.runSeed = checkpoint.runSeed;
+			resumedRoundPending = true;
+			Log("Resuming round %d at game %lld\n", checkpoint.round + 1, (long long)checkpoint.nextGame);
+		}
+		else
+		{
+			memcpy(checkpoint.magic, checkpointMagic, sizeof(checkpointMagic));
+			checkpoint.version = checkpointVersion;
+			checkpoint.playerCount = totalPlayerCount;
+			checkpoint.totalGameCount = totalGameCount;
+			checkpoint.boardSize = simulationSettings.boardSize;
+			checkpoint.winLength = simulationSettings.winLength;
+			checkpoint.scheduleType = (int32_t)simulationSettings.scheduleType;
+			checkpoint.settingsHash = CheckpointSettingsHash();
+			checkpoint.runSeed = simulationSettings.runSeed;
+			checkpoint.checkpointGames = simulationSettings.checkpointGames;
+		}
+	}
+
+	// Room for one round to start with, more is mapped as rounds are added
+	ResultsFile resultsFile;
+	bool writingResults = !simulationSettings.resultsPath.empty() && !simulationSettings.batchWorker;
+	if (writingResults && !ResultsFileCreate(&resultsFile, simulationSettings.resultsPath, totalPlayerCount, totalGameCount,
+		std::max(simulationSettings.roundCount, 1), checkpointing && simulationSettings.resume))
+	{
+		std::cerr << "Error: Could not map the results file '" << simulationSettings.resultsPath << "'." << std::endl;
+		ResultsFileClose(&resultsFile);
+		return 1;
+	}
+
+	ConstructAllGames(perGameData, gameSlotCount);
+
+	// Initialize each player
+	for (int i = 0; i < totalPlayerCount; i++)
+	{
+		new (&perPlayerData[i]) Player<Rules>();
+		perPlayerData[i].id = i;
+		perPlayerData[i].drawCount = 0;
+		perPlayerData[i].gamesPlayed = 0;
+		perPlayerData[i].loseCount = 0;
+		perPlayerData[i].winCount = 0;
+		perPlayerData[i].gamePool = &poolOfGames;
+		perPlayerData[i].playerPool = &poolOfPlayers;
+		perPlayerData[i].type = PlayerType::None;
+		perPlayerData[i].round = 0;
+		perPlayerData[i].gamesEndedWon = 0;
+		perPlayerData[i].gamesEndedDraw = 0;
+		perPlayerData[i].gamesEndedWonAsX = 0;
+		memset(perPlayerData[i].opponentWaits, 0, sizeof(perPlayerData[i].opponentWaits));
+		memset(perPlayerData[i].handoffs, 0, sizeof(perPlayerData[i].handoffs));
+		memset(perPlayerData[i].handoffNanoseconds, 0, sizeof(perPlayerData[i].handoffNanoseconds));
+		perPlayerData[i].cpu = -1;
+		perPlayerData[i].core = -1;
+		perPlayerData[i].cacheDomain = -1;
+		perPlayerData[i].node = 0;
+		perPlayerData[i].schedulePosition = -1;
+		perPlayerData[i].finishedGames = 0;
+		if (!cpuPlaces.empty())
+		{
+			const CpuPlace& place = cpuPlaces[i % cpuPlaces.size()];
+			perPlayerData[i].cpu = place.cpu;
+			perPlayerData[i].core = place.core;
+			perPlayerData[i].cacheDomain = place.cacheDomain;
+			perPlayerData[i].node = NumaNodeIndex(&numaLayout, place);
+		}
+		perPlayerData[i].myRand.Init(0, INT_MAX);
+		perPlayerData[i].strategy = playerStrategies[i % playerStrategies.size()];
+		if (countingPositions)
+			perPlayerData[i].positionStats.Init(PositionStats::playerCapacity);
+	}
+
+	BatchCoordinator coordinator;
+	coordinator.listenFd = -1;
+	if (coordinated)
+	{
+		coordinator.listenFd = OpenBatchSocket(simulationSettings.socketPath, true);
+		if (coordinator.listenFd == -1)
+		{
+			std::cerr << "Error: Could not listen on '" << simulationSettings.socketPath << "'." << std::endl;
+			return 1;
+		}
+		coordinator.seed = simulationSettings.runSeed;
+		Log("Coordinator listening on %s\n", simulationSettings.socketPath.c_str());
+
+#if defined(__linux__)
+		// Anything still buffered would be printed again by every worker
+		fflush(stdout);
+		for (int i = 0; i < simulationSettings.batchWorkerCount; i++)
+		{
+			int pid = fork();
+			if (pid == 0)
+			{
+				close(coordinator.listenFd);
+				int workerExitCode = RunBatchWorker(simulationSettings.socketPath, perPlayerData, &poolOfPlayers, &poolOfGames, totalPlayerCount);
+				fflush(stdout);
+				_exit(workerExitCode);
+			}
+			if (pid != -1)
+				coordinator.localWorkerPids.push_back(pid);
+		}
+#endif
+	}
+
+	// Round-robin and random pairings don't depend on results, so they are laid out once
+	//   and every round replays them. Swiss is paired from the scores of the round being
+	//   played and has to start over each round, and so does the queue's arrival counter.
+	//   Workers pair their own share of the games.
+	bool reuseSchedule = (simulationSettings.scheduleType != ScheduleType::Swiss && simulationSettings.scheduleType != ScheduleType::Queue);
+	if (reuseSchedule && playsLocally)
+	{
+		BuildSchedule(&schedule, simulationSettings.scheduleType, totalPlayerCount, totalGameCount, streaming, std::random_device()());
+	}
+
+	// With --rounds and a reusable schedule the player threads run every round back to back,
+	//   a player starts its next round as soon as it is done with the current one.
+	int roundsPerLaunch = (simulationSettings.roundCount > 0 && reuseSchedule && playsLocally) ? simulationSettings.roundCount : 1;
+
+	int round = resumedRoundPending ? checkpoint.round : 0;
+	bool playAgain = (simulationSettings.roundCount == 0 || round < simulationSettings.roundCount);
+	int exitCode = 0;
+
+	// Games played by this run, the part of a resumed round played before is not its own
+	int64_t runGames = resumedRoundPending ? -(resumedResults.totals.totalGamesWon + resumedResults.totals.totalGamesTied) : 0;
+	auto runStart = std::chrono::steady_clock::now();
+	poolOfPlayers.deadline = runStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<double>(simulationSettings.timeLimit));
+	if (playsLocally || checkpointing)
+	{
+		std::signal(SIGINT, InterruptHandler);
+	}
+
+	// Without a round count the run goes on for as long as the user wants, so there is no end to estimate
+	ProgressReporter progressReporter;
+	progressReporter.stopping = false;
+	if (simulationSettings.progressInterval > 0.0 && (playsLocally || checkpointing))
+	{
+		int64_t expectedGames = (simulationSettings.roundCount > 0) ? (simulationSettings.roundCount - round) * totalGameCount + runGames : 0;
+		progressReporter.thread = std::thread(ReportProgress<Rules>, &progressReporter, perPlayerData, totalPlayerCount, expectedGames,
+			poolOfPlayers.deadline);
+	}
+
+	if (simulationSettings.batchWorker)
+	{
+		// A worker has no rounds of its own, it plays whatever the coordinator hands it
+		exitCode = RunBatchWorker(simulationSettings.socketPath, perPlayerData, &poolOfPlayers, &poolOfGames, totalPlayerCount);
+		playAgain = false;
+	}
+
+	while (playAgain) {
+		int firstRound = round;
+		int lastRound = round + roundsPerLaunch;
+
+		if (!reuseSchedule && playsLocally)
+		{
+			BuildSchedule(&schedule, simulationSettings.scheduleType, totalPlayerCount, totalGameCount, streaming, std::random_device()());
+		}
+
+		// Make room for the results of the rounds about to be played
+		poolOfPlayers.roundResults.resize(lastRound);
+		for (int r = firstRound; r < lastRound; r++)
+		{
+			memset(&poolOfPlayers.roundResults[r].totals, 0, sizeof(poolOfPlayers.roundResults[r].totals));
+			poolOfPlayers.roundResults[r].playersFinished = 0;
+			poolOfPlayers.roundResults[r].players.assign(totalPlayerCount, PlayerRoundResult());
+		}
+		if (writingResults && !ResultsFileReserve(&resultsFile, lastRound))
+		{
+			std::cerr << "Error: Could not grow the results file '" << simulationSettings.resultsPath << "'." << std::endl;
+			exitCode = 1;
+			break;
+		}
+		GameOutcome* roundOutcomes = writingResults ? ResultsRecords(&resultsFile, round) : nullptr;
+		schedule.outcomes = writingResults ? ResultsRecords(&resultsFile, 0) : nullptr;
+
+		if (resumedRoundPending)
+		{
+			// Pick up the part of the round played before the checkpoint
+			poolOfPlayers.roundResults[round].totals = resumedResults.totals;
+			poolOfPlayers.roundResults[round].players = resumedResults.players;
+			resumedRoundPending = false;
+		}
+
+		if (sharded)
+		{
+			if (!PlayShardedRound(perPlayerData, &poolOfPlayers, &poolOfGames, &shardRegion, round, totalPlayerCount, totalGameCount, roundOutcomes))
+			{
+				std::cerr << "Error: A worker process failed, round " << (round + 1) << " is incomplete." << std::endl;
+				exitCode = 1;
+			}
+		}
+		else if (checkpointing)
+		{
+			if (!PlayCheckpointedRound(perPlayerData, &poolOfPlayers, &poolOfGames, &checkpoint, totalPlayerCount, writingResults ? &resultsFile : nullptr))
+			{
+				std::cerr << "Error: Round " << (round + 1) << " stopped early, resume it with --resume." << std::endl;
+				exitCode = 1;
+			}
+		}
+		else if (coordinated)
+		{
+			if (!PlayCoordinatedRound<Rules>(&coordinator, &poolOfPlayers, round, totalPlayerCount, totalGameCount, roundOutcomes))
+			{
+				std::cerr << "Error: All workers are gone, round " << (round + 1) << " is incomplete." << std::endl;
+				exitCode = 1;
+				poolOfPlayers.roundResults[round].playersFinished = totalPlayerCount;
+			}
+		}
+		else
+		{
+			StartPlayerThreads(perPlayerData, &poolOfPlayers, totalPlayerCount, firstRound, lastRound);
+		}
+
+		for (; round < lastRound; round++)
+		{
+			RoundResults* results = &poolOfPlayers.roundResults[round];
+			WaitForRound(perPlayerData, &poolOfPlayers, round, totalPlayerCount);
+
+			// A stopped round reports the games played before the stop, the rounds after it
+			//   have none to report
+			int64_t roundGames = results->totals.totalGamesWon + results->totals.totalGamesTied;
+			bool roundStopped = poolOfPlayers.stopRequested && roundGames < totalGameCount;
+			runGames += roundGames;
+			if (roundStopped && roundGames == 0)
+				continue;
+
+			if (roundsPerLaunch > 1)
+			{
+				Log("********* Round %d **********\n", round + 1);
+			}
+			if (roundStopped)
+			{
+				Log("Round %d stopped after %lld of %lld game(s)\n", round + 1, (long long)roundGames, (long long)totalGameCount);
+			}
+			else if (roundsPerLaunch == 1 && !streaming && playsLocally && !writingResults)
+			{
+				// The games are only stable to walk when no other round is running on them
+				PrintGameResults(perGameData, totalGameCount, round);
+			}
+			PrintResults(perPlayerData, totalPlayerCount, results);
+			PrintLeaderboard(perPlayerData, totalPlayerCount, results, &ratings);
+			if (simulationSettings.tlbStats)
+			{
+				PrintMemoryStats(&arena, &results->totals);
+			}
+			if (simulationSettings.waitStats)
+			{
+				PrintWaitStats(&results->totals);
+			}
+			if (simulationSettings.handoffStats)
+			{
+				PrintHandoffStats(&results->totals);
+			}
+
+			if (writingResults && exitCode == 0)
+			{
+				resultsFile.header->roundCount = round + 1;
+				if (checkpointing && !ResultsFileSync(&resultsFile))
+				{
+					std::cerr << "Error: Could not write the results to '" << simulationSettings.resultsPath << "'." << std::endl;
+					exitCode = 1;
+				}
+			}
+
+			if (checkpointing && exitCode == 0 && roundStopped)
+			{
+				Log("The checkpoint picks up where the round stopped, continue it with --resume\n");
+			}
+			else if (checkpointing && exitCode == 0)
+			{
+				// The round is reported, the next one starts from scratch
+				RoundResults nextRound;
+				nextRound.players.assign(totalPlayerCount, PlayerRoundResult());
+				checkpoint.round = round + 1;
+				checkpoint.nextGame = 0;
+				memset(&checkpoint.totals, 0, sizeof(checkpoint.totals));
+				if (!SaveCheckpoint(simulationSettings.checkpointPath, &checkpoint, &nextRound, &ratings))
+				{
+					std::cerr << "Error: Could not save the checkpoint to '" << simulationSettings.checkpointPath << "'." << std::endl;
+					exitCode = 1;
+				}
+			}
+		}
+
+		WaitForPlayerThreads(&poolOfPlayers);
+
+		// The searches of a sharded or coordinated run happened in the workers, there is
+		//   nothing to show here
+		for (size_t i = 0; i < playerStrategies.size() && !sharded && !coordinated; i++)
+		{
+			playerStrategies[i]->PrintStats();
+		}
+
+		if (exitCode != 0 || poolOfPlayers.stopRequested)
+		{
+			playAgain = false;
+		}
+		else if (simulationSettings.roundCount > 0)
+		{
+			// Keep going without asking until the requested number of rounds is played
+			playAgain = (round < simulationSettings.roundCount);
+		}
+		else
+		{
+			// Ask the user if they want to play again
+			char playAgainResponse;
+			std::cout << "Do you want to play again? (y/n): ";
+			std::cin >> playAgainResponse;
+
+			playAgain = (playAgainResponse == 'y' || playAgainResponse == 'Y');
+		}
+
+		// Cleanup
+		LogSync(LogSyncOperation::Release);
+	}
+
+	if (progressReporter.thread.joinable())
+	{
+		progressReporter.mutex.lock();
+		progressReporter.stopping = true;
+		progressReporter.mutex.unlock();
+		progressReporter.condition.notify_all();
+		progressReporter.thread.join();
+	}
+
+	std::signal(SIGINT, SIG_DFL);
+	if (poolOfPlayers.stopRequested || simulationSettings.timeLimit > 0.0)
+	{
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+		Log("%s%lld game(s) in %.1f s, %.0f games/s\n", poolOfPlayers.stopRequested ? "Stopped early, " : "", (long long)runGames, seconds,
+			(seconds > 0.0) ? runGames / seconds : 0.0);
+	}
+
+	if (countingPositions && !ExportPositionStats(perPlayerData, totalPlayerCount, simulationSettings.positionStatsPath))
+	{
+		std::cerr << "Error: Could not write the position statistics to '" << simulationSettings.positionStatsPath << "'." << std::endl;
+		exitCode = 1;
+	}
+
+	// Cleanup
+	for (int64_t i = 0; i < gameSlotCount; i++)
+	{
+		perGameData[i].~Game<Rules>();
+	}
+	for (int i = 0; i < totalPlayerCount; i++)
+	{
+		perPlayerData[i].~Player<Rules>();
+	}
+	ArenaRelease(&arena);
+	if (sharded)
+	{
+		ShardRegionRelease(&shardRegion);
+	}
+	if (coordinated)
+	{
+		StopBatchCoordinator(&coordinator, simulationSettings.socketPath);
+	}
+	if (writingResults)
+	{
+		Log("Game results written to %s\n", simulationSettings.resultsPath.c_str());
+		ResultsFileClose(&resultsFile);
+	}
+
+	return exitCode;
+}
+
+// Runs the simulation with the board configuration picked on the command line. Each
+//   supported configuration is compiled separately, add new ones here.
+int RunWithBoard(const char* programName, int totalPlayerCount, int64_t totalGameCount)
+{
+	const int size = simulationSettings.boardSize;
+	const int winLength = simulationSettings.winLength;
+
+	if (size == 3 && winLength == 3)
+		return RunSimulation<ClassicRules>(programName, totalPlayerCount, totalGameCount);
+	if (size == 4 && winLength == 4)
+		return RunSimulation<BoardRules<4, 4>>(programName, totalPlayerCount, totalGameCount);
+	if (size == 5 && winLength == 4)
+		return RunSimulation<BoardRules<5, 4>>(programName, totalPlayerCount, totalGameCount);
+	if (size == 15 && winLength == 5)
+		return RunSimulation<BoardRules<15, 5>>(programName, totalPlayerCount, totalGameCount);
+
+	std::cerr << "Error: Unsupported board " << size << "x" << size << " with " << winLength
+		<< " in a row. Supported boards are 3x3 (3), 4x4 (4), 5x5 (4) and 15x15 (5)." << std::endl;
+	return 1;
+}
+
+int main(int argc, char** argv)
+{
+	// Total number of games we're going to be playing.
+	int64_t totalGameCount;
+	// Total number of players that will be playing.
+	int totalPlayerCount;
+
+	simulationSettings.boardSize = 3;
+	simulationSettings.winLength = 0;
+	simulationSettings.mctsPlayouts = 1000;
+	simulationSettings.mctsTimeMs = 0;
+	simulationSettings.mctsThreads = 1;
+	simulationSettings.mctsLeafParallel = false;
+	simulationSettings.scheduleType = ScheduleType::RoundRobin;
+	simulationSettings.eloKFactor = 16.0;
+	simulationSettings.hugePages = HugePageMode::Off;
+	simulationSettings.parallelFirstTouch = false;
+	simulationSettings.tlbStats = false;
+	simulationSettings.waitSpins = -1;
+	simulationSettings.waitYields = -1;
+	simulationSettings.waitStats = false;
+	simulationSettings.placement = PlacementPolicy::None;
+	simulationSettings.handoffStats = false;
+	simulationSettings.numa = NumaMode::Off;
+	simulationSettings.timeLimit = 0.0;
+	simulationSettings.progressInterval = 0.0;
+	simulationSettings.roundCount = 0;
+	simulationSettings.streamGames = false;
+	simulationSettings.processCount = 1;
+	simulationSettings.batchWorker = false;
+	simulationSettings.batchWorkerCount = 0;
+	simulationSettings.checkpointGames = 1000000;
+	simulationSettings.resume = false;
+	simulationSettings.runSeedGiven = false;
+	simulationSettings.positionStatsDepth = 9;
+	simulationSettings.replayThreads = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--quiet") == 0)
+		{
+			simulationSettings.quiet = true;
+		}
+		else if (strcmp(argv[i], "--strategy") == 0 && i + 1 < argc)
+		{
+			simulationSettings.strategies = argv[++i];
+		}
+		else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc)
+		{
+			simulationSettings.boardSize = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--win-length") == 0 && i + 1 < argc)
+		{
+			simulationSettings.winLength = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--mcts-playouts") == 0 && i + 1 < argc)
+		{
+			simulationSettings.mctsPlayouts = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--mcts-time") == 0 && i + 1 < argc)
+		{
+			simulationSettings.mctsTimeMs = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--schedule") == 0 && i + 1 < argc)
+		{
+			i++;
+			if (strcmp(argv[i], "round-robin") == 0)
+				simulationSettings.scheduleType = ScheduleType::RoundRobin;
+			else if (strcmp(argv[i], "swiss") == 0)
+				simulationSettings.scheduleType = ScheduleType::Swiss;
+			else if (strcmp(argv[i], "random") == 0)
+				simulationSettings.scheduleType = ScheduleType::RandomBalanced;
+			else if (strcmp(argv[i], "queue") == 0)
+				simulationSettings.scheduleType = ScheduleType::Queue;
+			else
+			{
+				std::cerr << "Error: Unknown schedule '" << argv[i] << "'." << std::endl;
+				Pause();
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--elo-k") == 0 && i + 1 < argc)
+		{
+			simulationSettings.eloKFactor = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--huge-pages") == 0 && i + 1 < argc)
+		{
+			i++;
+			if (strcmp(argv[i], "off") == 0)
+				simulationSettings.hugePages = HugePageMode::Off;
+			else if (strcmp(argv[i], "thp") == 0)
+				simulationSettings.hugePages = HugePageMode::Transparent;
+			else if (strcmp(argv[i], "explicit") == 0)
+				simulationSettings.hugePages = HugePageMode::Explicit;
+			else
+			{
+				std::cerr << "Error: Unknown huge page mode '" << argv[i] << "'." << std::endl;
+				Pause();
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--first-touch") == 0)
+		{
+			simulationSettings.parallelFirstTouch = true;
+		}
+		else if (strcmp(argv[i], "--tlb-stats") == 0)
+		{
+			simulationSettings.tlbStats = true;
+		}
+		else if (strcmp(argv[i], "--wait-spins") == 0 && i + 1 < argc)
+		{
+			simulationSettings.waitSpins = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--wait-yields") == 0 && i + 1 < argc)
+		{
+			simulationSettings.waitYields = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--wait-stats") == 0)
+		{
+			simulationSettings.waitStats = true;
+		}
+		else if (strcmp(argv[i], "--placement") == 0 && i + 1 < argc)
+		{
+			i++;
+			if (strcmp(argv[i], "none") == 0)
+				simulationSettings.placement = PlacementPolicy::None;
+			else if (strcmp(argv[i], "compact") == 0)
+				simulationSettings.placement = PlacementPolicy::Compact;
+			else if (strcmp(argv[i], "spread") == 0)
+				simulationSettings.placement = PlacementPolicy::Spread;
+			else
+			{
+				std::cerr << "Error: Unknown placement '" << argv[i] << "'." << std::endl;
+				Pause();
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--handoff-stats") == 0)
+		{
+			simulationSettings.handoffStats = true;
+		}
+		else if (strcmp(argv[i], "--progress") == 0 && i + 1 < argc)
+		{
+			simulationSettings.progressInterval = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--time-limit") == 0 && i + 1 < argc)
+		{
+			simulationSettings.timeLimit = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--numa") == 0 && i + 1 < argc)
+		{
+			i++;
+			if (strcmp(argv[i], "off") == 0)
+				simulationSettings.numa = NumaMode::Off;
+			else if (strcmp(argv[i], "local") == 0)
+				simulationSettings.numa = NumaMode::Local;
+			else if (strcmp(argv[i], "interleave") == 0)
+				simulationSettings.numa = NumaMode::Interleave;
+			else
+			{
+				std::cerr << "Error: Unknown NUMA mode '" << argv[i] << "'." << std::endl;
+				Pause();
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc)
+		{
+			simulationSettings.roundCount = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--stream") == 0)
+		{
+			simulationSettings.streamGames = true;
+		}
+		else if (strcmp(argv[i], "--processes") == 0 && i + 1 < argc)
+		{
+			simulationSettings.processCount = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--coordinator") == 0 && i + 1 < argc)
+		{
+			simulationSettings.socketPath = argv[++i];
+			simulationSettings.batchWorker = false;
+		}
+		else if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc)
+		{
+			simulationSettings.socketPath = argv[++i];
+			simulationSettings.batchWorker = true;
+		}
+		else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+		{
+			simulationSettings.batchWorkerCount = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc)
+		{
+			simulationSettings.checkpointPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--checkpoint-games") == 0 && i + 1 < argc)
+		{
+			simulationSettings.checkpointGames = atoll(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--resume") == 0)
+		{
+			simulationSettings.resume = true;
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			simulationSettings.runSeed = strtoull(argv[++i], nullptr, 10);
+			simulationSettings.runSeedGiven = true;
+		}
+		else if (strcmp(argv[i], "--results") == 0 && i + 1 < argc)
+		{
+			simulationSettings.resultsPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--analyze") == 0 && i + 1 < argc)
+		{
+			simulationSettings.analyzePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			simulationSettings.replayPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay-threads") == 0 && i + 1 < argc)
+		{
+			simulationSettings.replayThreads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--position-stats") == 0 && i + 1 < argc)
+		{
+			simulationSettings.positionStatsPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--position-depth") == 0 && i + 1 < argc)
+		{
+			simulationSettings.positionStatsDepth = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--mcts-threads") == 0 && i + 1 < argc)
+		{
+			simulationSettings.mctsThreads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--mcts-parallel") == 0 && i + 1 < argc)
+		{
+			i++;
+			if (strcmp(argv[i], "root") == 0)
+				simulationSettings.mctsLeafParallel = false;
+			else if (strcmp(argv[i], "leaf") == 0)
+				simulationSettings.mctsLeafParallel = true;
+			else
+			{
+				std::cerr << "Error: Unknown MCTS parallelization '" << argv[i] << "'." << std::endl;
+				Pause();
+				return 1;
+			}
+		}
+		else
+		{
+			std::cerr << "Error: Unknown argument '" << argv[i] << "'." << std::endl;
+			Pause();
+			return 1;
+		}
+	}
+
+	if (!simulationSettings.analyzePath.empty())
+	{
+		// Everything needed is in the file, there is nothing to ask
+		int analyzeResult = AnalyzeResultsFile(simulationSettings.analyzePath);
+		Pause();
+		return analyzeResult;
+	}
+	if (!simulationSettings.replayPath.empty())
+	{
+		int replayResult = ReplayResultsFile(simulationSettings.replayPath);
+		Pause();
+		return replayResult;
+	}
+
+	std::cout << "Enter the number of players: ";
+	std::cin >> totalPlayerCount;
+
+	if (totalPlayerCount < 2)
+	{
+		std::cerr << "Error: Requires at least two players." << std::endl;
+		Pause();
+		return 1;
+	}
+
+	std::cout << "Enter the number of games: ";
+	std::cin >> totalGameCount;
+
+	if (totalGameCount < 0 || totalPlayerCount < 0)
+	{
+		std::cerr << "Error: All arguments must be positive integer values." << std::endl;
+		Pause();
+		return 1;
+	}
+
+	if (totalGameCount < 0 || totalPlayerCount < 0)
+	{
+		fprintf(stderr, "Error: All arguments must be positive integer values.\n");
+		Pause();
+		return 1;
+	}
+
+	if (totalPlayerCount < 2)
+	{
+		fprintf(stderr, "Error: Requires at least two players.\n");
+		Pause();
+		return 1;
+	}
+
+	// The win length defaults to filling a whole row
+	if (simulationSettings.winLength == 0)
+	{
+		simulationSettings.winLength = simulationSettings.boardSize;
+	}
+
+	if (!simulationSettings.runSeedGiven)
+	{
+		std::random_device seedDevice;
+		simulationSettings.runSeed = ((uint64_t)seedDevice() << 32) | seedDevice();
+	}
+
+	if (simulationSettings.resume && simulationSettings.checkpointPath.empty())
+	{
+		fprintf(stderr, "Error: --resume needs the --checkpoint file to resume from.\n");
+		Pause();
+		return 1;
+	}
+
+	// Every position is tabled up front, strategies and the results check look things up in it
+	gameTreeTable.Build();
+
+	int result = RunWithBoard(argv[0], totalPlayerCount, totalGameCount);
+
+	Pause();
+	return result;
+}